@@ -0,0 +1,63 @@
+#ifndef VOXELENGINE_BLOCK_REGISTRY_H
+#define VOXELENGINE_BLOCK_REGISTRY_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "VoxelEngine/utils/texture_array.h"
+
+class file_watcher;
+class texture_loader;
+
+// Ids registered by BlockRegistry::registerDefaults, used by the terrain generator
+enum Block_Id : uint8_t {
+    BLOCK_AIR,
+    BLOCK_GRASS,
+    BLOCK_DIRT,
+    BLOCK_STONE
+};
+
+struct BlockMaterial {
+    std::string name;
+    glm::vec4 color;
+    // optional image, the color is used when it is empty or can't be loaded
+    std::string texturePath;
+};
+
+struct BlockType {
+    std::string name;
+    // texture array layer of each face, indexed by Chunk_Face
+    uint16_t faceLayers[6];
+};
+
+// Every block material is one layer of a single texture array, so the whole world renders with one texture binding
+class BlockRegistry {
+public:
+
+    std::vector<BlockMaterial> materials;
+    // indexed by block id, id 0 is air
+    std::vector<BlockType> blocks;
+    std::unique_ptr<texture_array> textures;
+
+    BlockRegistry();
+
+    int registerMaterial(const std::string &name, const glm::vec4 &color, const std::string &texturePath = "");
+    uint8_t registerBlock(const std::string &name, int material);
+    uint8_t registerBlock(const std::string &name, int top, int side, int bottom);
+    void registerDefaults();
+
+    uint16_t getFaceLayer(uint8_t id, int face) const {
+        return id < blocks.size() ? blocks[id].faceLayers[face] : 0;
+    }
+
+    // packs every material in a texture array of resolution x resolution layers stored with the given compression,
+    // the layers are filled in the background by the loader
+    void buildTextures(int resolution, texture_loader &loader, bc_format format = BC_FORMAT_NONE);
+    // loads the layer of a material again when its image is written, the old layer stays until the new one is uploaded
+    void watchTextures(file_watcher &watcher, texture_loader &loader);
+
+};
+
+#endif //VOXELENGINE_BLOCK_REGISTRY_H
@@ -0,0 +1,173 @@
+#ifndef VOXELENGINE_CHUNK_H
+#define VOXELENGINE_CHUNK_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "VoxelEngine/utils/slab_pool.h"
+
+const int CHUNK_SIZE = 16;
+const int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+// level 0 is full resolution, level n merges 2^n voxels along each axis
+const int CHUNK_LOD_COUNT = 4;
+// depth in voxels of the skirts hiding cracks between chunks drawn at different levels
+const int CHUNK_SKIRT_DEPTH = 1 << (CHUNK_LOD_COUNT - 1);
+// bit n selects level of detail n
+const uint8_t CHUNK_ALL_LODS = (1 << CHUNK_LOD_COUNT) - 1;
+
+// Chunk faces, a face and its opposite only differ by the lowest bit
+enum Chunk_Face {
+    FACE_NEG_X,
+    FACE_POS_X,
+    FACE_NEG_Y,
+    FACE_POS_Y,
+    FACE_NEG_Z,
+    FACE_POS_Z
+};
+
+const glm::ivec3 FACE_OFFSETS[6] = {
+        glm::ivec3(-1, 0, 0), glm::ivec3(1, 0, 0),
+        glm::ivec3(0, -1, 0), glm::ivec3(0, 1, 0),
+        glm::ivec3(0, 0, -1), glm::ivec3(0, 0, 1)
+};
+
+class BlockRegistry;
+
+inline int oppositeFace(int face) {
+    return face ^ 1;
+}
+
+struct ChunkKeyHash {
+    size_t operator()(const glm::ivec3 &key) const {
+        // large primes, see "Optimized Spatial Hashing for Collision Detection of Deformable Objects"
+        return (static_cast<size_t>(key.x) * 73856093u) ^ (static_cast<size_t>(key.y) * 19349663u) ^
+               (static_cast<size_t>(key.z) * 83492791u);
+    }
+};
+
+// GPU mesh of a chunk, vertices are position, normal, texture coords and texture array layer
+// indices start with the surface, followed by one skirt range per chunk face
+struct ChunkMesh {
+    // staging buffers, pooled since every remesh fills and drops them
+    pooled_vector<float> vertices;
+    pooled_vector<unsigned int> indices;
+
+    GLuint VAO = 0, VBO = 0, EBO = 0;
+    GLsizei indexCount = 0;
+    GLsizei surfaceCount = 0;
+    GLsizei skirtOffset[6] = {};
+    GLsizei skirtCount[6] = {};
+
+    void upload();
+    // skirtMask selects the faces, by Chunk_Face bit, whose neighbour is drawn at another level of detail
+    void draw(uint8_t skirtMask = 0) const;
+    void release();
+};
+
+using ChunkVoxelArray = pooled_vector<uint8_t>;
+
+// Voxel array of a chunk, shared by copying it. Snapshots and remesh jobs read a shared array without copying it,
+// the first edit made while it is shared gives the chunk its own copy so readers keep a consistent state.
+// Copies and edits must happen on the thread owning the chunk, readers only have to hold their copy.
+class ChunkVoxels {
+public:
+    ChunkVoxels();
+
+    uint8_t operator[](int index) const {
+        return (*storage)[index];
+    }
+
+    const uint8_t *data() const {
+        return storage->data();
+    }
+
+    const uint8_t *begin() const {
+        return storage->data();
+    }
+
+    const uint8_t *end() const {
+        return storage->data() + storage->size();
+    }
+
+    // writable array, copied first when anyone else holds it
+    uint8_t *edit() {
+        if (storage.use_count() != 1)
+            detach();
+        // a reader may have released the array since, its reads must happen before the writes that follow
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return storage->data();
+    }
+
+    std::shared_ptr<const ChunkVoxelArray> share() const {
+        return storage;
+    }
+
+private:
+    std::shared_ptr<ChunkVoxelArray> storage;
+
+    void detach();
+};
+
+class Chunk {
+public:
+
+    // position in chunk coordinates, the chunk covers [position, position + 1) * CHUNK_SIZE * scale world units
+    glm::ivec3 position;
+    // world units per voxel, 1 except for the coarse chunks of the clipmap
+    int scale;
+    // block ids, 0 is air, one pool block of CHUNK_VOLUME bytes
+    ChunkVoxels voxels;
+    ChunkMesh meshes[CHUNK_LOD_COUNT];
+
+    // connectivity[a] has bit b set when face a can see face b through air inside the chunk
+    std::array<uint8_t, 6> connectivity;
+    // frame stamp used by the visibility search
+    unsigned int visitedFrame;
+
+    explicit Chunk(const glm::ivec3 &position, int scale = 1);
+    ~Chunk();
+
+    Chunk(const Chunk &) = delete;
+    Chunk &operator=(const Chunk &) = delete;
+
+    static int index(int x, int y, int z) {
+        return x + CHUNK_SIZE * (y + CHUNK_SIZE * z);
+    }
+
+    uint8_t getVoxel(int x, int y, int z) const {
+        return voxels[index(x, y, z)];
+    }
+
+    void setVoxel(int x, int y, int z, uint8_t id) {
+        voxels.edit()[index(x, y, z)] = id;
+    }
+
+    // builds the CPU side meshes of the levels of detail selected by lodMask and the face connectivity,
+    // neighbours are indexed by Chunk_Face and may be null. The other meshes are left untouched
+    void buildMesh(const Chunk *const neighbours[6], const BlockRegistry &registry,
+                   uint8_t lodMask = CHUNK_ALL_LODS);
+
+    // downsampled voxel of a level of detail, solid when at least half of the merged voxels are solid
+    uint8_t getLodVoxel(int lod, int x, int y, int z) const;
+
+    int getSolidCount() const;
+    // true when the depth voxel layers along a face are all solid
+    bool isFaceSolid(int face, int depth) const;
+
+    bool canSeeThrough(int fromFace, int toFace) const {
+        return (connectivity[fromFace] >> toFace) & 1;
+    }
+
+    glm::vec3 getMin() const;
+    glm::vec3 getMax() const;
+
+private:
+    void buildLodMesh(int lod, const Chunk *const neighbours[6], const BlockRegistry &registry);
+    void computeConnectivity();
+
+};
+
+#endif //VOXELENGINE_CHUNK_H
@@ -0,0 +1,91 @@
+#ifndef VOXELENGINE_CLIPMAP_H
+#define VOXELENGINE_CLIPMAP_H
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "VoxelEngine/components/block_registry.h"
+#include "VoxelEngine/components/chunk.h"
+#include "VoxelEngine/components/terrain_generator.h"
+#include "VoxelEngine/utils/thread_pool.h"
+
+struct ClipmapCell {
+    // one chunk at the scale of the ring, or when the cell overlaps the detail region the finer chunks covering
+    // the part of the cell outside of it
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    bool split = false;
+    // set when the cell leaves its ring before the worker finished it
+    std::atomic<bool> cancelled{false};
+    bool ready = false;
+    // faces whose neighbour cell is not part of the same ring, skirts hide the cracks there. The chunks of a split
+    // cell also meet chunks of other scales inside the cell, they draw every skirt
+    uint8_t skirtMask = 0;
+};
+
+struct ClipmapRing {
+    // world units per voxel of the chunks of this ring
+    int scale;
+    // centre of the ring in chunk coordinates of the ring, always even so the inner ring fits on its cells
+    glm::ivec3 center;
+    std::unordered_map<glm::ivec3, std::shared_ptr<ClipmapCell>, ChunkKeyHash> cells;
+    // set once the ring has been filled, a ring left without cells is not scanned again every update
+    bool initialized = false;
+};
+
+// Nested rings of chunks around the camera, each ring covering twice the area of the previous one at half the resolution.
+// The total chunk count only depends on the ring count and size, not on the view distance.
+class Clipmap {
+public:
+
+    // half size of every ring in chunks, components must be even
+    glm::ivec3 halfExtent;
+    // chunks uploaded to the GPU per update, limits the frame time spent on streaming
+    int uploadBudget = 8;
+
+    std::vector<ClipmapRing> rings;
+    size_t drawnChunks = 0;
+
+    Clipmap(thread_pool &pool, const BlockRegistry &registry, int ringCount = 4, int firstScale = 2,
+            const glm::ivec3 &halfExtent = glm::ivec3(4, 2, 4));
+    ~Clipmap();
+
+    Clipmap(const Clipmap &) = delete;
+    Clipmap &operator=(const Clipmap &) = delete;
+
+    // cells entirely inside this box are skipped, it is drawn by the full resolution World. Cells overlapping it
+    // are split down to the World chunks, only the chunks outside of it are kept
+    void setDetailRegion(const glm::vec3 &min, const glm::vec3 &max);
+
+    // recentres the rings, unloads the cells that left them and queues generation of the new ones, inner rings first
+    void update(const glm::vec3 &cameraPosition);
+
+    void draw(const glm::mat4 &viewProjection);
+
+    size_t getChunkCount() const;
+    int getPendingCount() const;
+
+private:
+    thread_pool &pool;
+    const BlockRegistry &registry;
+    TerrainGenerator generator;
+    glm::vec3 detailMin = glm::vec3(0.0f), detailMax = glm::vec3(0.0f);
+    bool dirty = true;
+
+    // jobs queued or running, the destructor waits for them since they reference the clipmap
+    std::atomic<int> jobsInFlight{0};
+    std::mutex completedMutex;
+    std::vector<std::shared_ptr<ClipmapCell>> completed;
+
+    bool isInRing(int ring, const glm::ivec3 &cell) const;
+    bool intersectsDetail(const glm::vec3 &min, const glm::vec3 &max) const;
+    // adds the chunk to the cell when it is clear of the detail region, its eight halves otherwise
+    void addChunks(ClipmapCell &cell, const glm::ivec3 &position, int scale) const;
+    void updateRing(int ring, const glm::vec3 &cameraPosition);
+    void buildCell(ClipmapCell &cell);
+    void buildChunk(Chunk &chunk);
+};
+
+#endif //VOXELENGINE_CLIPMAP_H
@@ -16,6 +16,10 @@ public:
     std::vector<unsigned int> indices;
 
     ComplexeCube(float size, GLuint textureID);
+    ~ComplexeCube();
+
+    ComplexeCube(const ComplexeCube &) = delete;
+    ComplexeCube &operator=(const ComplexeCube &) = delete;
 
     void draw();
 
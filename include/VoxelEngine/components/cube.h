@@ -16,6 +16,10 @@ public:
     std::vector<unsigned int> indices;
 
     Cube(float size, GLuint textureID);
+    ~Cube();
+
+    Cube(const Cube &) = delete;
+    Cube &operator=(const Cube &) = delete;
 
     void draw();
 
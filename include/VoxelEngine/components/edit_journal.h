@@ -0,0 +1,112 @@
+#ifndef VOXELENGINE_EDIT_JOURNAL_H
+#define VOXELENGINE_EDIT_JOURNAL_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Changes of one chunk in one edit. Every changed voxel refers to a palette entry holding its old and new block,
+// runs of consecutive voxel indices sharing an entry are stored as varints: unchanged voxels skipped before the run,
+// run length, palette index. A filled box costs a few bytes per chunk row, a single voxel a few bytes in total.
+struct ChunkDelta {
+    glm::ivec3 position;
+    // old and new block id of each entry, interleaved
+    std::vector<uint8_t> palette;
+    std::vector<uint8_t> runs;
+};
+
+struct EditStep {
+    std::vector<ChunkDelta> deltas;
+    size_t voxelCount = 0;
+    size_t bytes = 0;
+};
+
+// file layout, little endian: "VJRN", version, step count, then for each step its delta count and for each delta
+// its position, palette size, palette, run bytes size and runs
+const uint32_t EDIT_JOURNAL_VERSION = 1;
+
+// Undo and redo history of voxel edits. Steps only hold the voxels they changed, the oldest ones are dropped once
+// the history goes over memoryLimit.
+class EditJournal {
+public:
+    size_t memoryLimit = 64 * 1024 * 1024;
+
+    // steps nest, everything recorded until the outermost endStep is undone at once
+    void beginStep();
+    void endStep();
+    bool isRecording() const;
+
+    // changes must be recorded by increasing voxel index between beginChunk and endChunk
+    void beginChunk(const glm::ivec3 &position);
+    void recordChange(int index, uint8_t previous, uint8_t id);
+    // the delta recorded for the chunk, null when nothing changed. It stays valid until the journal changes
+    const ChunkDelta *endChunk();
+
+    // the step to revert or apply again, null when there is none. It stays valid until the journal changes
+    const EditStep *undo();
+    const EditStep *redo();
+
+    size_t getUndoCount() const;
+    size_t getRedoCount() const;
+    size_t getMemoryUsage() const;
+    void clear();
+
+    // writes the undo history, oldest step first
+    bool save(const std::string &path) const;
+    // loads a saved history as steps to redo, replaying them on the world it was saved from
+    bool load(const std::string &path);
+
+    // true when the runs of a delta read from a file stay inside its chunk and its palette
+    static bool isValidDelta(const ChunkDelta &delta);
+
+    // calls change(index, previous, id) for every voxel of the delta, by increasing index
+    template<typename Change>
+    static void forEachChange(const ChunkDelta &delta, Change change) {
+        size_t offset = 0;
+        int index = 0;
+        while (offset < delta.runs.size()) {
+            index += static_cast<int>(readVarint(delta.runs, offset));
+            int length = static_cast<int>(readVarint(delta.runs, offset));
+            size_t entry = readVarint(delta.runs, offset) * 2;
+            for (int end = index + length; index < end; index++)
+                change(index, delta.palette[entry], delta.palette[entry + 1]);
+        }
+    }
+
+private:
+    std::deque<EditStep> undoSteps;
+    std::deque<EditStep> redoSteps;
+    size_t memoryUsage = 0;
+
+    int depth = 0;
+    EditStep current;
+
+    // run being recorded
+    ChunkDelta chunk;
+    bool chunkOpen = false;
+    int runStart = 0, runLength = 0, previousEnd = 0;
+    size_t runEntry = 0;
+
+    void flushRun();
+    void trim();
+
+    static void writeVarint(std::vector<uint8_t> &bytes, size_t value);
+
+    static size_t readVarint(const std::vector<uint8_t> &bytes, size_t &offset) {
+        size_t value = 0;
+        int shift = 0;
+        while (offset < bytes.size()) {
+            uint8_t byte = bytes[offset++];
+            value |= static_cast<size_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                break;
+            shift += 7;
+        }
+        return value;
+    }
+};
+
+#endif //VOXELENGINE_EDIT_JOURNAL_H
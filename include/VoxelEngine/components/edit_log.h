@@ -0,0 +1,87 @@
+#ifndef VOXELENGINE_EDIT_LOG_H
+#define VOXELENGINE_EDIT_LOG_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "VoxelEngine/components/edit_journal.h"
+
+class World;
+
+// segment file layout, little endian: "VWAL", version, then records of payload size, CRC-32 of the payload and
+// the payload: chunk position, palette size, palette, run bytes size and runs of a delta, old then new block
+const uint32_t EDIT_LOG_VERSION = 1;
+// log size past which the world should be saved so the log can be compacted
+const size_t EDIT_LOG_COMPACT_BYTES = 8 * 1024 * 1024;
+
+// Write-ahead log of the voxel edits made since the last saved regions. Appending only encodes the delta into a
+// buffer, a thread of its own checksums the records and writes them with one write and one fsync per syncInterval,
+// so a crash loses at most the last interval of edits. The log is split into numbered segment files, a segment
+// is deleted once a world snapshot taken after it was saved. Replaying stops at the first damaged record of a
+// segment, the tail a crash left half written.
+class EditLog {
+public:
+    // seconds between two flushes of the appended records
+    float syncInterval = 0.05f;
+
+    explicit EditLog(const std::string &directory);
+    // writes and syncs the records appended so far
+    ~EditLog();
+
+    EditLog(const EditLog &) = delete;
+    EditLog &operator=(const EditLog &) = delete;
+
+    // replays the segments left by the previous runs on a world whose regions are already loaded,
+    // returns the number of deltas applied. Call it once, before anything is appended
+    size_t replay(World &world);
+
+    // with reverse the old blocks of the delta are logged as the new ones, an undo is logged as an edit
+    void append(const ChunkDelta &delta, bool reverse);
+
+    // the edits appended from now on go to a new segment, returns its number
+    uint32_t startSegment();
+    // deletes the segments before segment once the snapshot taken when it started is saved
+    void compact(uint32_t segment);
+
+    // bytes of the segments on disk
+    size_t getSize() const;
+    float getLastSyncMilliseconds() const;
+
+private:
+    struct Batch {
+        uint32_t segment;
+        std::vector<uint8_t> bytes;
+    };
+
+    std::string directory;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+    // records waiting for the next flush, checksums are filled in by the flushing thread
+    std::deque<Batch> batches;
+    uint32_t segment = 1;
+    uint32_t compactBefore = 0;
+
+    // owned by the flushing thread once replay returns
+    int file = -1;
+    uint32_t fileSegment = 0;
+    std::vector<uint32_t> segments;
+
+    std::atomic<size_t> size{0};
+    std::atomic<float> lastSyncMilliseconds{0.0f};
+
+    void flushLoop();
+    void flush(std::deque<Batch> &pending);
+    void deleteSegments(uint32_t before);
+    std::string getSegmentPath(uint32_t number) const;
+};
+
+#endif //VOXELENGINE_EDIT_LOG_H
@@ -0,0 +1,203 @@
+#ifndef VOXELENGINE_ENTITY_REGISTRY_H
+#define VOXELENGINE_ENTITY_REGISTRY_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "VoxelEngine/utils/thread_pool.h"
+
+const int MAX_COMPONENT_TYPES = 64;
+// bit n is set when the component type of id n is present
+using ComponentMask = uint64_t;
+
+// The index is reused once the entity is destroyed, the generation tells the old handle from the new entity
+struct Entity {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator==(const Entity &other) const {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool operator!=(const Entity &other) const {
+        return !(*this == other);
+    }
+};
+
+// Ids are handed out the first time a component type is used. Components are plain data, archetypes move them
+// around as bytes
+class ComponentTypes {
+public:
+    template<typename T>
+    static int getId() {
+        static_assert(std::is_trivially_copyable<T>::value, "components are copied as bytes");
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "component columns use the default alignment");
+        static const int id = registerType(sizeof(T));
+        return id;
+    }
+
+    static size_t getSize(int id);
+
+private:
+    static int registerType(size_t size);
+};
+
+// Entities having exactly the same component types. Every component type has its own array, indexed by row,
+// so a system reads only the components it uses, one contiguous array each
+struct Archetype {
+    ComponentMask mask = 0;
+    // indexed by component id, empty for the types the archetype does not have
+    std::vector<uint8_t> columns[MAX_COMPONENT_TYPES];
+    std::vector<Entity> entities;
+
+    size_t size() const {
+        return entities.size();
+    }
+
+    template<typename T>
+    T *getColumn() {
+        return reinterpret_cast<T *>(columns[ComponentTypes::getId<T>()].data());
+    }
+};
+
+// Archetype based entity component storage. Adding or removing a component moves the entity to the archetype of
+// its new component set, destroying it moves the last row of its archetype into its place. Systems iterate whole
+// archetype arrays, on the calling thread or split into batches across a thread pool.
+// Entities must not be created, changed or destroyed while iterating.
+class EntityRegistry {
+public:
+    template<typename... Components>
+    Entity create(const Components &... components) {
+        Entity entity = createEntity(getMask<Components...>());
+        int unpack[] = {0, (*get<Components>(entity) = components, 0)...};
+        (void) unpack;
+        return entity;
+    }
+
+    void destroy(Entity entity);
+    void clear();
+    bool isAlive(Entity entity) const;
+
+    // null when the entity is dead or does not have the component
+    template<typename T>
+    T *get(Entity entity) {
+        if (!isAlive(entity))
+            return nullptr;
+        const EntityRecord &record = records[entity.index];
+        Archetype &archetype = archetypes[record.archetype];
+        int id = ComponentTypes::getId<T>();
+        if ((archetype.mask & (ComponentMask(1) << id)) == 0)
+            return nullptr;
+        return archetype.getColumn<T>() + record.row;
+    }
+
+    // replaces the value when the entity already has the component
+    template<typename T>
+    void add(Entity entity, const T &component) {
+        if (!isAlive(entity))
+            return;
+        ComponentMask mask = archetypes[records[entity.index].archetype].mask;
+        moveEntity(entity, mask | (ComponentMask(1) << ComponentTypes::getId<T>()));
+        *get<T>(entity) = component;
+    }
+
+    template<typename T>
+    void remove(Entity entity) {
+        if (!isAlive(entity))
+            return;
+        ComponentMask mask = archetypes[records[entity.index].archetype].mask;
+        moveEntity(entity, mask & ~(ComponentMask(1) << ComponentTypes::getId<T>()));
+    }
+
+    // calls function(count, Components *...) once per archetype having all the components
+    template<typename... Components, typename Function>
+    void forEach(Function function) {
+        ComponentMask mask = getMask<Components...>();
+        for (Archetype &archetype : archetypes) {
+            if ((archetype.mask & mask) == mask && archetype.size() > 0)
+                function(archetype.size(), archetype.getColumn<Components>()...);
+        }
+    }
+
+    // same as forEach with the rows split into batches of at most batchSize run on the pool, returns once every
+    // batch is done. Must not be called from a worker of the pool, it would wait for jobs queued behind it
+    template<typename... Components, typename Function>
+    void forEachParallel(thread_pool &pool, size_t batchSize, Function function) {
+        ComponentMask mask = getMask<Components...>();
+        std::atomic<int> remaining{0};
+        for (Archetype &archetype : archetypes) {
+            if ((archetype.mask & mask) != mask)
+                continue;
+            std::tuple<Components *...> columns(archetype.getColumn<Components>()...);
+            for (size_t first = 0; first < archetype.size(); first += batchSize) {
+                size_t count = std::min(batchSize, archetype.size() - first);
+                remaining++;
+                // ahead of the remeshing and streaming jobs, the frame waits for systems
+                pool.enqueue([&function, &remaining, columns, first, count] {
+                    std::apply([&function, first, count](Components *... column) {
+                        function(count, (column + first)...);
+                    }, columns);
+                    remaining--;
+                }, -2);
+            }
+        }
+        while (remaining.load() > 0)
+            std::this_thread::yield();
+    }
+
+    // entities having all the components
+    template<typename... Components>
+    size_t count() const {
+        ComponentMask mask = getMask<Components...>();
+        size_t total = 0;
+        for (const Archetype &archetype : archetypes) {
+            if ((archetype.mask & mask) == mask)
+                total += archetype.size();
+        }
+        return total;
+    }
+
+    size_t getEntityCount() const;
+    size_t getArchetypeCount() const;
+
+    template<typename... Components>
+    static ComponentMask getMask() {
+        ComponentMask mask = 0;
+        int unpack[] = {0, (mask |= ComponentMask(1) << ComponentTypes::getId<Components>(), 0)...};
+        (void) unpack;
+        return mask;
+    }
+
+private:
+    struct EntityRecord {
+        uint32_t archetype = 0;
+        uint32_t row = 0;
+        uint32_t generation = 0;
+        bool alive = false;
+    };
+
+    std::vector<Archetype> archetypes;
+    std::unordered_map<ComponentMask, uint32_t> archetypeIndices;
+    std::vector<EntityRecord> records;
+    std::vector<uint32_t> freeIndices;
+    size_t entityCount = 0;
+
+    uint32_t getArchetype(ComponentMask mask);
+    // appends a zeroed row to the archetype of mask
+    Entity createEntity(ComponentMask mask);
+    // appends a zeroed row and returns its index
+    uint32_t addRow(Archetype &archetype, Entity entity);
+    // moves the last row into row, fixing the record of the entity moved
+    void removeRow(Archetype &archetype, uint32_t row);
+    void moveEntity(Entity entity, ComponentMask mask);
+};
+
+#endif //VOXELENGINE_ENTITY_REGISTRY_H
@@ -0,0 +1,44 @@
+#ifndef VOXELENGINE_ENTITY_SYSTEMS_H
+#define VOXELENGINE_ENTITY_SYSTEMS_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "VoxelEngine/components/entity_registry.h"
+#include "VoxelEngine/utils/thread_pool.h"
+
+// Components of the dynamic objects of the world, mobs, dropped items and projectiles are all made of these
+struct Position {
+    glm::vec3 value;
+};
+
+// world units per second
+struct Velocity {
+    glm::vec3 value;
+};
+
+// drawn as an instanced cube of this size
+struct Renderable {
+    float scale;
+};
+
+// rows handed to one job by the parallel systems
+const size_t ENTITY_BATCH_SIZE = 4096;
+
+// Systems run over every entity having their components. With a pool they split the archetypes into batches
+// across the workers and return once every batch is done, without one they run on the calling thread.
+
+// moves every entity by its velocity, entities leaving the box [min, max] bounce back in
+void updateMotion(EntityRegistry &registry, thread_pool *pool, float deltaTime, const glm::vec3 &min,
+                  const glm::vec3 &max);
+
+// appends the model matrix of every renderable entity to matrices, in no particular order, for the instanced
+// cube draw. Returns the number of matrices appended
+size_t appendInstanceMatrices(EntityRegistry &registry, thread_pool *pool, std::vector<glm::mat4> &matrices);
+
+// count entities at random positions of [min, max] moving at up to speed along each axis
+void spawnMovingEntities(EntityRegistry &registry, size_t count, const glm::vec3 &min, const glm::vec3 &max,
+                         float speed, uint32_t seed);
+
+#endif //VOXELENGINE_ENTITY_SYSTEMS_H
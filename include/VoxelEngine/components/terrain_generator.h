@@ -0,0 +1,16 @@
+#ifndef VOXELENGINE_TERRAIN_GENERATOR_H
+#define VOXELENGINE_TERRAIN_GENERATOR_H
+
+#include <glm/glm.hpp>
+#include "VoxelEngine/components/chunk.h"
+
+// Heightmap terrain with 3D noise caves below the surface, stateless so it can be used from any thread
+class TerrainGenerator {
+public:
+
+    // fills the local voxel box [min, max) of the chunk, each voxel samples the terrain every chunk.scale world units
+    void fill(Chunk &chunk, const glm::ivec3 &min = glm::ivec3(0), const glm::ivec3 &max = glm::ivec3(CHUNK_SIZE)) const;
+
+};
+
+#endif //VOXELENGINE_TERRAIN_GENERATOR_H
@@ -0,0 +1,66 @@
+#ifndef VOXELENGINE_VOXEL_PHYSICS_H
+#define VOXELENGINE_VOXEL_PHYSICS_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "VoxelEngine/components/world.h"
+
+// Axis aligned boxes moving through the voxel grid, one array per component so a batch is walked linearly and the
+// integration loops vectorize. Positions are the centre of the bottom face of the box
+struct PhysicsBodies {
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<float> velocityX, velocityY, velocityZ;
+    // half the size of the box along x and z, and its full height
+    std::vector<float> halfWidth, height;
+    // highest ledge the body walks onto without jumping, 0 to disable
+    std::vector<float> stepHeight;
+    // 1 for falling bodies, 0 for flying ones
+    std::vector<float> gravityScale;
+    std::vector<uint8_t> onGround;
+
+    size_t add(const glm::vec3 &position, float halfWidth, float height, float stepHeight = 0.0f);
+    size_t size() const;
+    void clear();
+
+    glm::vec3 getPosition(size_t body) const {
+        return glm::vec3(positionX[body], positionY[body], positionZ[body]);
+    }
+};
+
+// Moves bodies against the solid voxels of a world. Every axis is swept on its own, y first, over every voxel layer
+// the box crosses, so fast bodies cannot tunnel through thin walls. A body standing on the ground and blocked
+// horizontally tries again stepHeight higher, which walks it up ledges.
+class VoxelPhysics {
+public:
+    // world units per second squared
+    float gravity = 28.0f;
+    float terminalVelocity = 60.0f;
+
+    explicit VoxelPhysics(const World &world);
+
+    // bodies [first, last), disjoint ranges of the same batch can be stepped on several threads while the world
+    // is not edited
+    void step(PhysicsBodies &bodies, float deltaTime, size_t first, size_t last) const;
+
+    void step(PhysicsBodies &bodies, float deltaTime) const {
+        step(bodies, deltaTime, 0, bodies.size());
+    }
+
+private:
+    // last chunk looked up, neighbouring voxels of a body nearly always share it
+    struct VoxelCache {
+        glm::ivec3 position = glm::ivec3(INT32_MIN);
+        const Chunk *chunk = nullptr;
+    };
+
+    const World &world;
+
+    bool isSolid(VoxelCache &cache, int x, int y, int z) const;
+    bool isLayerSolid(VoxelCache &cache, const glm::vec3 &min, const glm::vec3 &max, int axis, int layer) const;
+    // moves the box [min, max] by distance along axis until it touches a solid voxel, returns the distance moved
+    float sweep(VoxelCache &cache, glm::vec3 &min, glm::vec3 &max, int axis, float distance) const;
+};
+
+#endif //VOXELENGINE_VOXEL_PHYSICS_H
@@ -0,0 +1,193 @@
+#ifndef VOXELENGINE_WORLD_H
+#define VOXELENGINE_WORLD_H
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "VoxelEngine/components/block_registry.h"
+#include "VoxelEngine/components/chunk.h"
+#include "VoxelEngine/components/edit_journal.h"
+#include "VoxelEngine/components/terrain_generator.h"
+#include "VoxelEngine/utils/frustum.h"
+#include "VoxelEngine/utils/thread_pool.h"
+
+class EditLog;
+
+struct VoxelHit {
+    // voxel that was hit and the empty voxel in front of the face the ray entered through
+    glm::ivec3 voxel;
+    glm::ivec3 previous;
+    float distance;
+};
+
+// Voxels copied out of the world, x varies fastest then y then z like inside a chunk
+struct VoxelRegion {
+    glm::ivec3 size = glm::ivec3(0);
+    std::vector<uint8_t> voxels;
+
+    uint8_t get(int x, int y, int z) const {
+        return voxels[x + size.x * (y + size.y * z)];
+    }
+};
+
+// Voxels of every chunk at the time the snapshot was taken. The arrays are shared with the world, which copies
+// the array of a chunk before editing it while a snapshot holds it, so a snapshot only costs memory for the chunks
+// edited during its lifetime. It can be read from any thread
+struct WorldSnapshot {
+    struct Entry {
+        glm::ivec3 position;
+        std::shared_ptr<const ChunkVoxelArray> voxels;
+    };
+
+    std::vector<Entry> chunks;
+    // chunks edited since the previous snapshot
+    std::vector<glm::ivec3> edited;
+};
+
+class World {
+public:
+
+    // the generated area covers chunks [-radius, radius) horizontally and [minChunkY, maxChunkY) vertically
+    int radius;
+    int minChunkY, maxChunkY;
+
+    std::unordered_map<glm::ivec3, std::unique_ptr<Chunk>, ChunkKeyHash> chunks;
+    // chunks selected by the last updateVisibility call
+    std::vector<Chunk *> visibleChunks;
+
+    // every edit is one undo step, wrap several in journal.beginStep and endStep to undo them together
+    EditJournal journal;
+    // when set every change, undo and redo included, is appended to it
+    EditLog *editLog = nullptr;
+
+    // when false only frustum culling is applied
+    bool connectivityCulling = true;
+
+    // chunks closer than lodDistance chunks use full resolution, each doubling of the distance selects the next level
+    bool lodEnabled = true;
+    float lodDistance = 4.0f;
+
+    World(thread_pool &pool, const BlockRegistry &registry, int radius, int minChunkY, int maxChunkY);
+    ~World();
+
+    World(const World &) = delete;
+    World &operator=(const World &) = delete;
+
+    void generate();
+
+    // voxels in world coordinates, outside of the generated area everything is air and edits are ignored
+    uint8_t getVoxel(const glm::ivec3 &position) const;
+    // marks the chunk dirty, and the neighbours sharing the voxel's faces when it is on a border,
+    // every edit of a frame is remeshed together on the next update
+    bool setVoxel(const glm::ivec3 &position, uint8_t id);
+
+    // Bulk edits of the box [min, max), they write the chunk storage directly and visit every chunk once so each
+    // touched chunk is remeshed once. They return the number of voxels that changed
+    size_t fillBox(const glm::ivec3 &min, const glm::ivec3 &max, uint8_t id);
+    // voxels whose centre is inside the sphere, air carves a hole
+    size_t fillSphere(const glm::vec3 &center, float radius, uint8_t id);
+    // voxels outside of the generated area are copied as air
+    void copyRegion(const glm::ivec3 &min, const glm::ivec3 &max, VoxelRegion &region) const;
+    // with skipAir the air of the region leaves the world untouched, which stamps structures into the terrain
+    size_t pasteRegion(const VoxelRegion &region, const glm::ivec3 &origin, bool skipAir);
+
+    // takes a few microseconds per thousand chunks, nothing is copied until the next edits
+    WorldSnapshot createSnapshot();
+    // gives back the edited chunks of a snapshot that could not be saved, the next snapshot includes them again
+    void markUnsaved(const std::vector<glm::ivec3> &positions);
+    size_t getUnsavedCount() const;
+    // replaces the CHUNK_VOLUME voxels of a chunk without recording an edit, false outside of the generated area
+    bool loadChunk(const glm::ivec3 &position, const uint8_t *voxels);
+
+    // writes the new blocks of a logged delta, it is neither recorded in the journal nor logged again
+    void replayDelta(const ChunkDelta &delta);
+
+    // false when there is nothing to undo or redo
+    bool undo();
+    bool redo();
+
+    // first solid voxel along the ray, direction must be normalized
+    bool raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, VoxelHit &hit) const;
+
+    // uploads the remeshed chunks and queues the dirty ones, a chunk is never remeshed by two jobs at once
+    void update();
+
+    // milliseconds from the first edit of a chunk to the upload of its new mesh, for the chunks uploaded by the
+    // last update
+    const std::vector<float> &getEditLatencies() const;
+    int getRemeshPendingCount() const;
+
+    Chunk *getChunk(const glm::ivec3 &position) const;
+
+    static glm::ivec3 worldToChunk(const glm::vec3 &position);
+
+    // bounds of the generated area in world units
+    glm::vec3 getMin() const;
+    glm::vec3 getMax() const;
+
+    // walks the chunk graph from the camera chunk, only through faces that see each other and chunks inside the frustum
+    void updateVisibility(const glm::vec3 &cameraPosition, const glm::mat4 &viewProjection);
+
+    // level of detail of a chunk for the camera position given to the last updateVisibility call
+    int getChunkLod(const glm::ivec3 &position) const;
+
+    void draw() const;
+
+private:
+    // the chunk and its neighbours sharing the voxels of the originals, the worker meshes them while the originals
+    // keep being drawn and edited
+    struct RemeshJob {
+        glm::ivec3 position;
+        // profiler::now() of the first edit the job includes
+        uint64_t editTime;
+        // levels of detail the job meshes, the others keep their current mesh
+        uint8_t lods;
+        std::unique_ptr<Chunk> chunk;
+        std::unique_ptr<Chunk> neighbours[6];
+    };
+
+    unsigned int frameCounter = 0;
+    glm::vec3 lodCenter = glm::vec3(0.0f);
+    thread_pool &pool;
+    const BlockRegistry &registry;
+    TerrainGenerator generator;
+
+    struct DirtyChunk {
+        // profiler::now() of the first edit since the chunk was last queued
+        uint64_t editTime;
+        // levels of detail to mesh again, by bit
+        uint8_t lods;
+    };
+
+    std::unordered_map<glm::ivec3, DirtyChunk, ChunkKeyHash> dirtyChunks;
+    std::unordered_set<glm::ivec3, ChunkKeyHash> remeshing;
+    // chunks edited since the last snapshot
+    std::unordered_set<glm::ivec3, ChunkKeyHash> unsavedChunks;
+    std::vector<float> editLatencies;
+
+    // jobs queued or running, the destructor waits for them since they reference the world
+    std::atomic<int> jobsInFlight{0};
+    std::mutex completedMutex;
+    std::vector<std::shared_ptr<RemeshJob>> completed;
+
+    void meshChunk(Chunk &chunk) const;
+    void markDirty(const glm::ivec3 &position, uint64_t time, uint8_t lods);
+    // min and max bound the edited voxels, in voxels of the chunk. The neighbours remesh the levels of detail that
+    // read them, see getNeighbourLods
+    void markEdited(const glm::ivec3 &position, const glm::ivec3 &min, const glm::ivec3 &max, uint64_t time);
+    void applyDelta(const ChunkDelta &delta, bool reverse);
+    void logDelta(const ChunkDelta *delta, bool reverse);
+    // calls edit(position, voxel) on every voxel of the box, chunk by chunk, and marks the chunks it changed dirty
+    template<typename Edit>
+    size_t editBox(const glm::ivec3 &min, const glm::ivec3 &max, Edit edit);
+    void queueRemesh(const glm::ivec3 &position, const DirtyChunk &dirty);
+    void applyRemesh(RemeshJob &job);
+    void collectInFrustum(const frustum &frustum);
+};
+
+#endif //VOXELENGINE_WORLD_H
@@ -0,0 +1,76 @@
+#ifndef VOXELENGINE_WORLD_SAVER_H
+#define VOXELENGINE_WORLD_SAVER_H
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "VoxelEngine/components/world.h"
+
+// chunks along each axis of a region file
+const int REGION_SIZE = 8;
+// file layout, little endian: "VREG", version, chunk count, then for each chunk its position, the byte size of its
+// runs and the runs, varint length and block id pairs covering the CHUNK_VOLUME voxels by increasing index
+const uint32_t REGION_FILE_VERSION = 1;
+
+struct WorldSaveStats {
+    size_t regionCount = 0;
+    size_t chunkCount = 0;
+    size_t bytes = 0;
+    float milliseconds = 0.0f;
+    // some region may not be on disk, written or not
+    bool failed = false;
+};
+
+// Writes world snapshots to region files from a thread of its own, the main thread only pays for taking the
+// snapshot. Only the regions holding edited chunks are written, the chunks of the other regions are generated
+// again identically. A region is written to a temporary file, synced and renamed over the previous one, so a crash
+// while saving leaves the previous save intact. A save only succeeds once the directory holding the renames is
+// synced as well, the edit log covering it can be compacted then.
+class WorldSaver {
+public:
+    explicit WorldSaver(const std::string &directory);
+    // finishes the save in progress
+    ~WorldSaver();
+
+    WorldSaver(const WorldSaver &) = delete;
+    WorldSaver &operator=(const WorldSaver &) = delete;
+
+    // false while the previous snapshot is still being written
+    bool save(WorldSnapshot snapshot);
+    bool isSaving() const;
+
+    WorldSaveStats getLastStats() const;
+    // edited chunks of the regions the last saves failed to write, to hand back to World::markUnsaved
+    std::vector<glm::ivec3> takeFailedChunks();
+
+    // loads every region file of the directory into a freshly generated world, returns the number of chunks loaded
+    size_t load(World &world) const;
+
+    static glm::ivec3 chunkToRegion(const glm::ivec3 &position);
+
+private:
+    std::string directory;
+
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    std::unique_ptr<WorldSnapshot> pending;
+    std::atomic<bool> saving{false};
+    bool stopping = false;
+
+    WorldSaveStats lastStats;
+    std::vector<glm::ivec3> failedChunks;
+
+    void saveLoop();
+    void write(const WorldSnapshot &snapshot);
+    std::string getRegionPath(const glm::ivec3 &region) const;
+};
+
+#endif //VOXELENGINE_WORLD_SAVER_H
@@ -0,0 +1,34 @@
+#ifndef VOXELENGINE_BC_ENCODER_H
+#define VOXELENGINE_BC_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Block compressed formats, the values are stored in cooked texture files
+enum bc_format : uint32_t {
+    BC_FORMAT_NONE = 0,
+    BC_FORMAT_BC1 = 1,
+    BC_FORMAT_BC3 = 2,
+    BC_FORMAT_BC7 = 3
+};
+
+// bytes per 4x4 block
+int bcBlockBytes(bc_format format);
+// bytes of a whole level, partial blocks on the borders count as full blocks
+size_t bcLevelSize(bc_format format, int width, int height);
+
+// blocks are 16 RGBA8 pixels in row order
+// BC1 stores opaque RGB in 4 bits per pixel, endpoints are fitted along the principal axis then refined
+void encodeBlockBC1(const unsigned char *rgba, unsigned char *out);
+// BC3 adds an 8 bit interpolated alpha block in front of a BC1 colour block, 8 bits per pixel
+void encodeBlockBC3(const unsigned char *rgba, unsigned char *out);
+// BC7 is only encoded with mode 6, one RGBA subset with 4 bit indices, 8 bits per pixel
+void encodeBlockBC7(const unsigned char *rgba, unsigned char *out);
+
+void decodeBlock(bc_format format, const unsigned char *block, unsigned char *rgba);
+
+std::vector<unsigned char> encodeImage(bc_format format, const unsigned char *rgba, int width, int height);
+std::vector<unsigned char> decodeImage(bc_format format, const unsigned char *data, int width, int height);
+
+#endif //VOXELENGINE_BC_ENCODER_H
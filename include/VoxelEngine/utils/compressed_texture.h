@@ -0,0 +1,26 @@
+#ifndef VOXELENGINE_COMPRESSED_TEXTURE_H
+#define VOXELENGINE_COMPRESSED_TEXTURE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "VoxelEngine/utils/bc_encoder.h"
+
+// Cooked texture: block compressed data of every mip level, written by the TextureCook tool.
+// File layout, little endian: "VTEX", version, format, width, height, level count, then for each level its size and data.
+struct compressed_image {
+    bc_format format;
+    int width, height;
+    std::vector<std::vector<unsigned char>> levels;
+};
+
+const uint32_t COMPRESSED_TEXTURE_VERSION = 1;
+// largest width or height read, the GL_MAX_TEXTURE_SIZE of current hardware. Files are read on worker threads
+// without a GL context to query it from
+const uint32_t COMPRESSED_TEXTURE_MAX_SIZE = 16384;
+
+bool writeCompressedTexture(const std::string &path, const compressed_image &image);
+// false for a missing, truncated or corrupt file, or one with sizes or a level count no texture can have
+bool readCompressedTexture(const std::string &path, compressed_image &image);
+
+#endif //VOXELENGINE_COMPRESSED_TEXTURE_H
@@ -0,0 +1,14 @@
+#ifndef VOXELENGINE_FILE_SYNC_H
+#define VOXELENGINE_FILE_SYNC_H
+
+#include <string>
+
+// Durable writes: a closed file is only on disk once fsynced, and a file created or renamed only survives a crash
+// once its directory is fsynced too. Both return false when the data may not have reached the disk.
+
+bool flushFileToDisk(const std::string &path);
+
+// does nothing on Windows, where directories cannot be synced and renames are journaled by the file system
+bool flushDirectoryToDisk(const std::string &path);
+
+#endif //VOXELENGINE_FILE_SYNC_H
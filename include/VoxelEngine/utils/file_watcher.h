@@ -0,0 +1,53 @@
+#ifndef VOXELENGINE_FILE_WATCHER_H
+#define VOXELENGINE_FILE_WATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Calls back when watched files are written. On Linux the directories are watched with inotify,
+// elsewhere the modification times are polled. Callbacks only run from update(), on the thread calling it.
+class file_watcher {
+public:
+    // seconds between two scans of the modification times when inotify is not used
+    float pollInterval = 0.5f;
+
+    file_watcher();
+    ~file_watcher();
+
+    file_watcher(const file_watcher &) = delete;
+    file_watcher &operator=(const file_watcher &) = delete;
+
+    // the callback runs once per update even when several of the files changed. Returns the id of the watch
+    int watch(const std::vector<std::string> &paths, std::function<void()> callback);
+    // replaces the files of a watch, e.g. with the includes a reloaded shader resolved. May be called from the
+    // callback of the watch
+    void setPaths(int id, const std::vector<std::string> &paths);
+
+    void update();
+
+private:
+    struct entry {
+        std::vector<std::string> paths;
+        std::vector<std::filesystem::file_time_type> writeTimes;
+        std::function<void()> callback;
+    };
+
+    std::vector<entry> entries;
+    std::chrono::steady_clock::time_point lastPoll;
+
+    // inotify descriptor and the directory of every watch descriptor, -1 when polling
+    int inotifyFD = -1;
+    std::unordered_map<int, std::string> directories;
+
+    static std::string normalize(const std::string &path);
+    static std::filesystem::file_time_type getWriteTime(const std::string &path);
+    void watchDirectory(const std::string &directory);
+    // paths written since the last call
+    std::vector<std::string> readEvents();
+};
+
+#endif //VOXELENGINE_FILE_WATCHER_H
@@ -0,0 +1,56 @@
+#ifndef VOXELENGINE_FRAME_ARENA_H
+#define VOXELENGINE_FRAME_ARENA_H
+
+#include "VoxelEngine/utils/linear_arena.h"
+
+// arenas the main thread cycles through, data of a frame stays valid until the end of the next one
+const int FRAME_ARENA_COUNT = 2;
+const size_t FRAME_ARENA_SIZE = 256 * 1024;
+const size_t SCRATCH_ARENA_SIZE = 64 * 1024;
+
+// Transient memory of the main thread, everything allocated during a frame is freed at once two frames later.
+class frame_arena {
+public:
+    // called once at the start of every frame, before anything allocates from the arena
+    static void beginFrame();
+
+    static linear_arena &get();
+
+    template<typename T>
+    static arena_allocator<T> allocator() {
+        return arena_allocator<T>(get());
+    }
+
+    static size_t getFrameIndex();
+};
+
+// Temporary memory of the calling thread, for work that does not follow frames like the pool jobs.
+// Allocations must happen inside a scratch_scope, which gives them back when it ends.
+class scratch_arena {
+public:
+    static linear_arena &get();
+
+    template<typename T>
+    static arena_allocator<T> allocator() {
+        return arena_allocator<T>(get());
+    }
+};
+
+class scratch_scope {
+public:
+    scratch_scope() : arena(scratch_arena::get()), start(arena.getMarker()) {
+    }
+
+    ~scratch_scope() {
+        arena.rewind(start);
+    }
+
+    scratch_scope(const scratch_scope &) = delete;
+    scratch_scope &operator=(const scratch_scope &) = delete;
+
+private:
+    linear_arena &arena;
+    linear_arena::marker start;
+};
+
+#endif //VOXELENGINE_FRAME_ARENA_H
@@ -0,0 +1,81 @@
+#ifndef VOXELENGINE_FRAME_STATS_H
+#define VOXELENGINE_FRAME_STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// Streaming quantile estimate with the P² algorithm (Jain and Chlamtac), five markers and no stored samples
+class p2_quantile {
+public:
+    explicit p2_quantile(float quantile);
+
+    void add(float value);
+    float get() const;
+    void reset();
+
+private:
+    float quantile;
+    int count = 0;
+    float heights[5];
+    float positions[5];
+    float desired[5];
+    float increments[5];
+
+    float parabolic(int i, float direction) const;
+    float linear(int i, int direction) const;
+};
+
+// Consistent copy of the statistics, times in milliseconds. Mean, min and max cover the window,
+// the percentiles every frame since the last reset.
+struct frame_stats_summary {
+    uint64_t frameCount = 0;
+    float last = 0.0f;
+    float mean = 0.0f;
+    float min = 0.0f;
+    float max = 0.0f;
+    float p50 = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+};
+
+// Fixed size window of frame times. One thread pushes, every statistic is updated in constant time per frame,
+// and any thread can read the summary or the recent frames without locking.
+class frame_stats {
+public:
+    explicit frame_stats(size_t capacity = 1024);
+
+    frame_stats(const frame_stats &) = delete;
+    frame_stats &operator=(const frame_stats &) = delete;
+
+    // producer thread only
+    void push(float frameTime);
+    void resetPercentiles();
+
+    // any thread
+    frame_stats_summary getSummary() const;
+    // copies up to count of the newest frame times, oldest first, and returns how many were copied
+    size_t copyRecent(float *output, size_t count) const;
+    size_t getCapacity() const;
+
+private:
+    std::vector<std::atomic<float>> samples;
+    std::atomic<uint64_t> written{0};
+
+    // producer side running state
+    double sum = 0.0;
+    // frame indices with decreasing times for the max and increasing times for the min, the front is the extreme
+    std::deque<std::pair<uint64_t, float>> maxWindow, minWindow;
+    p2_quantile p50{0.5f}, p95{0.95f}, p99{0.99f};
+
+    // summary published with a sequence lock, odd while it is being written
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint64_t> publishedCount{0};
+    std::atomic<float> publishedLast{0.0f}, publishedMean{0.0f}, publishedMin{0.0f}, publishedMax{0.0f};
+    std::atomic<float> publishedP50{0.0f}, publishedP95{0.0f}, publishedP99{0.0f};
+};
+
+#endif //VOXELENGINE_FRAME_STATS_H
@@ -0,0 +1,54 @@
+#ifndef VOXELENGINE_FRUSTUM_H
+#define VOXELENGINE_FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+// View frustum stored as 6 planes (left, right, bottom, top, near, far) extracted from a view-projection matrix
+class frustum
+{
+public:
+    glm::vec4 planes[6];
+
+    frustum() = default;
+
+    explicit frustum(const glm::mat4 &viewProjection)
+    {
+        update(viewProjection);
+    }
+
+    // extracts the planes with the Gribb/Hartmann method, glm matrices are column major so row i is m[0][i]..m[3][i]
+    void update(const glm::mat4 &m)
+    {
+        glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        planes[0] = row3 + row0;
+        planes[1] = row3 - row0;
+        planes[2] = row3 + row1;
+        planes[3] = row3 - row1;
+        planes[4] = row3 + row2;
+        planes[5] = row3 - row2;
+
+        for (glm::vec4 &plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    // returns false only when the box is completely outside one of the planes
+    bool isBoxVisible(const glm::vec3 &min, const glm::vec3 &max) const
+    {
+        for (const glm::vec4 &plane : planes)
+        {
+            // test the corner that lies the furthest along the plane normal
+            glm::vec3 positive(plane.x >= 0.0f ? max.x : min.x,
+                               plane.y >= 0.0f ? max.y : min.y,
+                               plane.z >= 0.0f ? max.z : min.z);
+            if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif //VOXELENGINE_FRUSTUM_H
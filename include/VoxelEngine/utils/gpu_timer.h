@@ -0,0 +1,46 @@
+#ifndef VOXELENGINE_GPU_TIMER_H
+#define VOXELENGINE_GPU_TIMER_H
+
+#include <glad/glad.h>
+#include <vector>
+#include "VoxelEngine/utils/profiler.h"
+
+// frames in flight before a query is read back, the CPU never waits on the GPU for its results
+const int GPU_TIMER_LATENCY = 4;
+const int GPU_TIMER_MAX_PHASES = 16;
+
+// GPU time of the phases of a frame measured with GL_TIME_ELAPSED queries. The queries of a frame are kept in a ring
+// slot and read GPU_TIMER_LATENCY frames later, a slot whose results are still not available is dropped.
+class gpu_timer {
+public:
+    gpu_timer();
+    ~gpu_timer();
+
+    gpu_timer(const gpu_timer &) = delete;
+    gpu_timer &operator=(const gpu_timer &) = delete;
+
+    // reads the results of the oldest slot and starts recording the new frame into it
+    void beginFrame();
+
+    // phases can't nest or overlap, only one GL_TIME_ELAPSED query may be active.
+    // The name must be a string literal.
+    void begin(const char *name);
+    void end();
+
+    // phases of the most recent frame whose results were read
+    const std::vector<phase_time> &getLatest() const;
+
+private:
+    struct frame_slot {
+        GLuint queries[GPU_TIMER_MAX_PHASES];
+        const char *names[GPU_TIMER_MAX_PHASES];
+        int count = 0;
+    };
+
+    frame_slot slots[GPU_TIMER_LATENCY];
+    int current = 0;
+    bool active = false;
+    std::vector<phase_time> latest;
+};
+
+#endif //VOXELENGINE_GPU_TIMER_H
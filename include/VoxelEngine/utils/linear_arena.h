@@ -0,0 +1,105 @@
+#ifndef VOXELENGINE_LINEAR_ARENA_H
+#define VOXELENGINE_LINEAR_ARENA_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator, single threaded. Memory is only given back all at once by reset or by rewinding to a marker.
+// A full block makes the arena continue in a new heap block, the next reset replaces all of them by one block
+// big enough for the peak so a steady workload stops allocating after its first frames.
+class linear_arena {
+public:
+    struct marker {
+        size_t block = 0;
+        size_t offset = 0;
+        size_t committed = 0;
+    };
+
+    explicit linear_arena(size_t capacity);
+    ~linear_arena();
+
+    linear_arena(const linear_arena &) = delete;
+    linear_arena &operator=(const linear_arena &) = delete;
+
+    // alignment must be a power of two, never returns nullptr
+    void *allocate(size_t size, size_t alignment);
+
+    template<typename T>
+    T *allocate(size_t count) {
+        return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void reset();
+
+    marker getMarker() const;
+    // frees everything allocated after the marker, rewinding to an empty arena is a reset
+    void rewind(const marker &position);
+
+    size_t getUsed() const;
+    size_t getPeak() const;
+    size_t getCapacity() const;
+
+private:
+    struct block {
+        unsigned char *data;
+        size_t size;
+    };
+
+    std::vector<block> blocks;
+    size_t offset = 0;
+    // bytes used in the blocks before the current one
+    size_t committed = 0;
+    size_t peak = 0;
+
+    void addBlock(size_t size);
+    void releaseBlocks(size_t keep);
+};
+
+// Lets standard containers allocate from an arena, deallocate does nothing.
+// Containers must not outlive the arena data they point into, reserving up front avoids wasting the grown copies.
+template<typename T>
+class arena_allocator {
+public:
+    using value_type = T;
+    // moved and swapped containers keep pointing into the arena they allocated from
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit arena_allocator(linear_arena &arena) : arena(&arena) {
+    }
+
+    template<typename U>
+    arena_allocator(const arena_allocator<U> &other) : arena(other.getArena()) {
+    }
+
+    T *allocate(size_t count) {
+        return arena->allocate<T>(count);
+    }
+
+    void deallocate(T *, size_t) {
+    }
+
+    linear_arena *getArena() const {
+        return arena;
+    }
+
+private:
+    linear_arena *arena;
+};
+
+template<typename T, typename U>
+bool operator==(const arena_allocator<T> &a, const arena_allocator<U> &b) {
+    return a.getArena() == b.getArena();
+}
+
+template<typename T, typename U>
+bool operator!=(const arena_allocator<T> &a, const arena_allocator<U> &b) {
+    return a.getArena() != b.getArena();
+}
+
+template<typename T>
+using arena_vector = std::vector<T, arena_allocator<T>>;
+
+#endif //VOXELENGINE_LINEAR_ARENA_H
@@ -0,0 +1,84 @@
+#ifndef VOXELENGINE_MEMORY_TRACKER_H
+#define VOXELENGINE_MEMORY_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Subsystem an allocation is charged to, CPU allocations take the tag of the innermost MEMORY_SCOPE of their thread
+enum memory_tag : uint8_t {
+    MEMORY_UNTAGGED,
+    MEMORY_CHUNKS,
+    MEMORY_MESHES,
+    MEMORY_TEXTURES,
+    MEMORY_RENDERING,
+    MEMORY_PROFILER,
+    MEMORY_ARENAS,
+    MEMORY_POOLS,
+    MEMORY_ENTITIES,
+    MEMORY_TAG_COUNT
+};
+
+enum gpu_resource : uint8_t {
+    GPU_BUFFER,
+    GPU_TEXTURE
+};
+
+struct memory_tag_stats {
+    int64_t cpuBytes = 0;
+    int64_t cpuPeak = 0;
+    int64_t cpuAllocations = 0;
+    int64_t gpuBytes = 0;
+    int64_t gpuPeak = 0;
+};
+
+// Byte counts per tag. With VOXELENGINE_TRACK_MEMORY the global operator new and delete put a 16 byte header in
+// front of every block holding its size and tag, so frees are charged back to the tag that allocated them.
+// GPU memory is declared next to every glBufferData and glTexImage call, by object name so re-uploads replace it.
+class memory_tracker {
+public:
+    static bool isTrackingCPU();
+    static const char *getTagName(memory_tag tag);
+
+    static memory_tag getThreadTag();
+    static void setThreadTag(memory_tag tag);
+
+    // allocations made by the calling thread since it started, the difference over a frame shows what still allocates
+    static uint64_t getThreadAllocationCount();
+
+    // bytes is the whole storage of the object, a previous size of the same object is replaced
+    static void trackGPU(gpu_resource resource, unsigned int id, memory_tag tag, size_t bytes);
+    static void releaseGPU(gpu_resource resource, unsigned int id);
+
+    static memory_tag_stats getStats(memory_tag tag);
+
+    // per tag totals followed by every live GPU object
+    static bool dump(const std::string &path);
+
+    // used by the operator new hooks, allocations is +1 for an allocation and -1 for a free
+    static void trackCPU(memory_tag tag, int64_t bytes, int64_t allocations);
+};
+
+// Charges the allocations of the current thread to a tag until the end of the scope
+class memory_scope {
+public:
+    explicit memory_scope(memory_tag tag) : previous(memory_tracker::getThreadTag()) {
+        memory_tracker::setThreadTag(tag);
+    }
+
+    ~memory_scope() {
+        memory_tracker::setThreadTag(previous);
+    }
+
+    memory_scope(const memory_scope &) = delete;
+    memory_scope &operator=(const memory_scope &) = delete;
+
+private:
+    memory_tag previous;
+};
+
+#define MEMORY_CONCAT_INNER(a, b) a##b
+#define MEMORY_CONCAT(a, b) MEMORY_CONCAT_INNER(a, b)
+#define MEMORY_SCOPE(tag) memory_scope MEMORY_CONCAT(memoryScope, __LINE__)(tag)
+
+#endif //VOXELENGINE_MEMORY_TRACKER_H
@@ -0,0 +1,19 @@
+#ifndef VOXELENGINE_MIPMAP_H
+#define VOXELENGINE_MIPMAP_H
+
+#include <vector>
+
+// One RGBA8 level of an image
+struct image_level {
+    int width, height;
+    std::vector<unsigned char> pixels;
+};
+
+// nearest neighbour resize, used to fit images to the size of a texture array
+image_level resizeImage(const unsigned char *rgba, int width, int height, int newWidth, int newHeight);
+
+// full box filtered mip chain down to 1x1, level 0 is a copy of the source,
+// with srgb the colour channels are averaged in linear space so mips don't darken
+std::vector<image_level> generateMipChain(const unsigned char *rgba, int width, int height, bool srgb = true);
+
+#endif //VOXELENGINE_MIPMAP_H
@@ -0,0 +1,68 @@
+#ifndef VOXELENGINE_PROFILER_H
+#define VOXELENGINE_PROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One closed zone, times are nanoseconds since the profiler started
+struct profile_event {
+    // zone names must be string literals, only the pointer is stored
+    const char *name;
+    uint64_t start;
+    uint64_t duration;
+    // nesting level of the zone on its thread, 0 for outermost zones
+    uint32_t depth;
+};
+
+// Time spent in one phase of a frame, used for both the CPU zones and the GPU timer queries
+struct phase_time {
+    const char *name;
+    float milliseconds;
+};
+
+// Hierarchical CPU zones recorded into one ring buffer per thread. Recording never locks, only the first zone of
+// a thread registers its buffer. The newest PROFILER_RING_SIZE zones of every thread are kept.
+class profiler {
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    static uint64_t now();
+    static void setThreadName(const std::string &name);
+
+    static void record(const char *name, uint64_t start, uint64_t end, uint32_t depth);
+
+    // zones of the calling thread recorded since the given time, in the order they were closed
+    // events is overwritten, keeping it between calls keeps its storage
+    static void getThreadEvents(uint64_t since, std::vector<profile_event> &events);
+
+    // trace event JSON of every thread, opens in chrome://tracing and ui.perfetto.dev
+    static bool exportChromeTrace(const std::string &path);
+};
+
+const uint32_t PROFILER_RING_SIZE = 1 << 16;
+
+// Zone open for the lifetime of the object, see PROFILE_SCOPE
+class profile_scope {
+public:
+    explicit profile_scope(const char *name);
+    ~profile_scope();
+
+    // ends the zone before the end of the scope
+    void close();
+
+    profile_scope(const profile_scope &) = delete;
+    profile_scope &operator=(const profile_scope &) = delete;
+
+private:
+    const char *name;
+    uint64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) profile_scope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+
+#endif //VOXELENGINE_PROFILER_H
@@ -0,0 +1,67 @@
+#ifndef VOXELENGINE_PROFILER_OVERLAY_H
+#define VOXELENGINE_PROFILER_OVERLAY_H
+
+#include <imgui.h>
+#include <vector>
+#include "VoxelEngine/utils/profiler.h"
+
+// frames kept in the graphs, about 4 seconds at 60 fps
+const int OVERLAY_HISTORY = 240;
+const int OVERLAY_MAX_PHASES = 16;
+// voxel edits whose latency is kept for the statistics
+const int OVERLAY_EDIT_HISTORY = 64;
+
+struct frame_breakdown {
+    float frameTime = 0.0f;
+    int cpuCount = 0;
+    int gpuCount = 0;
+    phase_time cpu[OVERLAY_MAX_PHASES];
+    phase_time gpu[OVERLAY_MAX_PHASES];
+};
+
+// Per frame CPU and GPU phase timings drawn as stacked bars, with a frame time histogram and percentiles.
+// A spike freezes the graphs on the frames around it until it is resumed, single slow frames would scroll away otherwise.
+class profiler_overlay {
+public:
+    bool captureSpikes = true;
+    // a frame slower than this many times the median frame is a spike
+    float spikeFactor = 2.5f;
+    // height of the bar graphs in milliseconds
+    float graphMilliseconds = 33.3f;
+
+    profiler_overlay();
+
+    // frame time in milliseconds, the direct children of the frame zone in cpuEvents are the CPU phases
+    void addFrame(float frameTime, const std::vector<profile_event> &cpuEvents, const std::vector<phase_time> &gpuPhases);
+    // milliseconds from a voxel edit to the upload of the mesh showing it
+    void addEditLatency(float milliseconds);
+
+    // draws into the current ImGui window
+    void draw();
+
+    bool isFrozen() const;
+
+private:
+    std::vector<frame_breakdown> history;
+    size_t next = 0;
+    size_t count = 0;
+
+    bool frozen = false;
+    // oldest first, what the graphs show while frozen
+    std::vector<frame_breakdown> frozenFrames;
+    // reused every frame so drawing does not allocate once they reached the history size
+    std::vector<frame_breakdown> ordered;
+    std::vector<float> scratch;
+
+    std::vector<float> editLatencies;
+    size_t editNext = 0;
+    size_t editCount = 0;
+
+    void getFrames(std::vector<frame_breakdown> &frames) const;
+    float getPercentile(const std::vector<frame_breakdown> &frames, float percentile);
+    void drawPhaseGraph(const char *label, const std::vector<frame_breakdown> &frames, bool gpu) const;
+
+    static ImU32 getPhaseColor(const char *name);
+};
+
+#endif //VOXELENGINE_PROFILER_OVERLAY_H
@@ -0,0 +1,26 @@
+#ifndef VOXELENGINE_PROGRAM_CACHE_H
+#define VOXELENGINE_PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+
+// Linked program binaries stored on disk so later launches skip compiling and linking.
+// Binaries only come from the exact same driver, the key hashes the sources with the vendor, renderer and version strings.
+class program_cache {
+public:
+    // loads the GL 4.1 / ARB_get_program_binary entry points the glad loader does not have,
+    // the cache stays disabled when the driver exposes no binary format
+    static void init(GLADloadproc load, const std::string &directory);
+    static bool isEnabled();
+
+    static uint64_t makeKey(const std::string &vertexSource, const std::string &fragmentSource);
+
+    // must be called before glLinkProgram for the binary to be retrievable afterwards
+    static void prepare(GLuint program);
+    // true when a valid binary was found and the program is linked
+    static bool load(GLuint program, uint64_t key);
+    static void store(GLuint program, uint64_t key);
+};
+
+#endif //VOXELENGINE_PROGRAM_CACHE_H
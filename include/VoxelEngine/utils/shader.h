@@ -8,6 +8,31 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Location of a uniform resolved once, the type makes sure it is only set with the value it was declared with
+template<typename T>
+struct uniform
+{
+    GLint location = -1;
+};
+
+// Preprocessed GLSL of both stages, see preprocessShader
+struct shader_source
+{
+    std::string vertex;
+    std::string fragment;
+
+    std::string vertexPath, fragmentPath;
+    std::vector<std::string> defines;
+    // both stages with all their includes, the files to watch for a reload
+    std::vector<std::string> files;
+
+    // false when a file or one of its includes could not be read
+    bool load(const std::string &vertexPath, const std::string &fragmentPath,
+              const std::vector<std::string> &defines = {});
+};
 
 class shader
 {
@@ -15,8 +40,30 @@ public:
 
     unsigned int ID;
     shader(const GLchar* vertexPath, const GLchar* fragmentPath);
+    explicit shader(const shader_source &source);
+    ~shader();
+
+    shader(const shader &) = delete;
+    shader &operator=(const shader &) = delete;
+
     void use();
 
+    // reads and builds the files again, the new program only replaces the current one when it links.
+    // Locations and handles taken before a successful reload must be fetched again.
+    // The files are those of the last read, a link error in a newly included file is fixed by saving it
+    bool reload();
+    const std::vector<std::string> &getFiles() const;
+
+    // looked up in the tables filled at link time, -1 when the program has no such active variable
+    GLint getUniformLocation(const std::string &name) const;
+    GLint getAttributeLocation(const std::string &name) const;
+
+    template<typename T>
+    uniform<T> getUniform(const std::string &name) const
+    {
+        return uniform<T>{getUniformLocation(name)};
+    }
+
     void setBool(const std::string &name, bool value) const;
     void setInt(const std::string &name, int value) const;
     void setFloat(const std::string &name, float value) const;
@@ -29,8 +76,32 @@ public:
     void setMat2(const std::string &name, const glm::mat2 &value) const;
     void setMat3(const std::string &name, const glm::mat3 &value) const;
     void setMat4(const std::string &name, const glm::mat4 &value) const;
+
+    // the program must be in use, the handles skip the lookup entirely
+    void set(uniform<bool> handle, bool value) const;
+    void set(uniform<int> handle, int value) const;
+    void set(uniform<float> handle, float value) const;
+    void set(uniform<glm::vec2> handle, const glm::vec2 &value) const;
+    void set(uniform<glm::vec3> handle, const glm::vec3 &value) const;
+    void set(uniform<glm::vec4> handle, const glm::vec4 &value) const;
+    void set(uniform<glm::mat2> handle, const glm::mat2 &value) const;
+    void set(uniform<glm::mat3> handle, const glm::mat3 &value) const;
+    void set(uniform<glm::mat4> handle, const glm::mat4 &value) const;
 private:
-    void checkCompileErrors(unsigned int shader, std::string type);
+    std::string vertexPath, fragmentPath;
+    std::vector<std::string> defines;
+    std::vector<std::string> files;
+
+    std::unordered_map<std::string, GLint> uniforms;
+    std::unordered_map<std::string, GLint> attributes;
+
+    // true when the shader compiled or the program linked
+    static bool checkCompileErrors(unsigned int shader, std::string type);
+    // compiles and links, unless the program cache has a binary of these sources
+    static unsigned int createProgram(const std::string &vertexCode, const std::string &fragmentCode, bool &linked);
+    void setOrigin(const shader_source &source);
+    // fills the location tables and binds the FrameData block
+    void reflect();
 };
 
 #endif //VOXELENGINE_SHADER_H
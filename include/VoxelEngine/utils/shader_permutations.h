@@ -0,0 +1,66 @@
+#ifndef VOXELENGINE_SHADER_PERMUTATIONS_H
+#define VOXELENGINE_SHADER_PERMUTATIONS_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "VoxelEngine/utils/file_watcher.h"
+#include "VoxelEngine/utils/shader.h"
+#include "VoxelEngine/utils/thread_pool.h"
+
+// Variants of one vertex/fragment pair, compiled with a #define per enabled feature instead of branching in GLSL.
+// Bit n of a feature mask enables features[n]. Sources are read and preprocessed on the thread pool,
+// the programs are only compiled on the GL thread, either by update() or when get() needs them.
+class shader_permutations {
+public:
+    // permutations compiled per update, a cold compile costs several milliseconds
+    int compileBudget = 1;
+
+    // setup runs once on the GL thread after a permutation is built, e.g. to assign its samplers
+    shader_permutations(thread_pool &pool, std::string vertexPath, std::string fragmentPath,
+                        std::vector<std::string> features, std::function<void(shader &)> setup = nullptr);
+
+    shader_permutations(const shader_permutations &) = delete;
+    shader_permutations &operator=(const shader_permutations &) = delete;
+
+    // starts preprocessing in the background so the permutation is ready before it is first drawn
+    void request(uint32_t featureMask);
+    // compiles the requested permutations whose sources are ready, within the budget
+    void update();
+
+    // builds the permutation right away when it is not compiled yet
+    shader &get(uint32_t featureMask);
+    bool isReady(uint32_t featureMask) const;
+    size_t getCompiledCount() const;
+
+    // reloads every compiled permutation when one of the files changes, the includes are the same for all of them.
+    // The files are those every reload resolved, an include added since is watched from then on
+    void watch(file_watcher &watcher);
+    void reload();
+
+private:
+    struct pending_source {
+        shader_source source;
+        std::atomic<bool> done{false};
+    };
+
+    thread_pool &pool;
+    std::string vertexPath, fragmentPath;
+    std::vector<std::string> features;
+    std::function<void(shader &)> setup;
+    file_watcher *watcher = nullptr;
+    int watchId = -1;
+
+    std::unordered_map<uint32_t, std::unique_ptr<shader>> compiled;
+    // the jobs only hold the shared state, the permutations may be destroyed before they finish
+    std::unordered_map<uint32_t, std::shared_ptr<pending_source>> pending;
+
+    std::vector<std::string> getDefines(uint32_t featureMask) const;
+    shader &build(uint32_t featureMask, const shader_source &source);
+};
+
+#endif //VOXELENGINE_SHADER_PERMUTATIONS_H
@@ -0,0 +1,14 @@
+#ifndef VOXELENGINE_SHADER_PREPROCESSOR_H
+#define VOXELENGINE_SHADER_PREPROCESSOR_H
+
+#include <string>
+#include <vector>
+
+// Expands #include "file" directives, paths are relative to the including file and every file is included once.
+// The defines ("NAME" or "NAME VALUE") are injected right after the #version line.
+// #line directives give every file its own source string number, files[n] is the path of source string n.
+// Returns false and logs the reason when a file cannot be read or includes itself.
+bool preprocessShader(const std::string &path, const std::vector<std::string> &defines, std::string &output,
+                      std::vector<std::string> *files = nullptr);
+
+#endif //VOXELENGINE_SHADER_PREPROCESSOR_H
@@ -0,0 +1,67 @@
+#ifndef VOXELENGINE_SIMULATION_LOOP_H
+#define VOXELENGINE_SIMULATION_LOOP_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Runs a simulation step at a fixed rate whatever the frame rate, see "Fix Your Timestep!" (Glenn Fiedler).
+// The steps run either from update() on the render thread or on a thread of their own. Every step holds the
+// mutex, the render thread locks it to read or change the simulated state, and interpolates between the last
+// two steps with getAlpha() so motion stays smooth when frames and steps do not line up.
+class simulation_loop {
+public:
+    // steps run at once when the simulation fell behind, the rest of the delay is dropped so a long stall slows
+    // the simulation down instead of making it spiral
+    int maxCatchUpSteps = 8;
+
+    simulation_loop(float stepSeconds, std::function<void(float)> step);
+    ~simulation_loop();
+
+    simulation_loop(const simulation_loop &) = delete;
+    simulation_loop &operator=(const simulation_loop &) = delete;
+
+    // runs the steps due on the calling thread, does nothing while threaded. Must not be called holding the mutex
+    void update();
+
+    // must not be called holding the mutex
+    void setThreaded(bool threaded);
+    bool isThreaded() const;
+
+    std::mutex &getMutex();
+
+    // time elapsed since the last step, as a fraction of a step between 0 and 1
+    float getAlpha() const;
+    float getStepSeconds() const;
+    uint64_t getStepCount() const;
+    // duration of the last step
+    float getStepMilliseconds() const;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    const clock::duration stepDuration;
+    const float stepSeconds;
+    std::function<void(float)> step;
+
+    std::mutex mutex;
+    // time the next step is due, in clock ticks
+    std::atomic<clock::rep> nextStep;
+    std::atomic<uint64_t> stepCount{0};
+    std::atomic<float> stepMilliseconds{0.0f};
+
+    std::thread thread;
+    std::mutex threadMutex;
+    std::condition_variable threadCondition;
+    bool stopping = false;
+
+    // runs the steps due at now, returns the time the next one is due
+    clock::time_point runDueSteps(clock::time_point now);
+    void threadLoop();
+};
+
+#endif //VOXELENGINE_SIMULATION_LOOP_H
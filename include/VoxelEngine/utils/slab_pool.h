@@ -0,0 +1,76 @@
+#ifndef VOXELENGINE_SLAB_POOL_H
+#define VOXELENGINE_SLAB_POOL_H
+
+#include <cstddef>
+#include <vector>
+
+// size classes are the powers of two from SLAB_MIN_BLOCK to SLAB_MAX_BLOCK, bigger requests go to the heap
+const size_t SLAB_MIN_BLOCK = 64;
+const size_t SLAB_MAX_BLOCK = 256 * 1024;
+const int SLAB_CLASS_COUNT = 13;
+// memory reserved at once when a size class runs out, split into blocks of that class
+const size_t SLAB_SIZE = 256 * 1024;
+// blocks of a class a thread keeps for itself before giving half of them back to the global pool
+const size_t SLAB_THREAD_CACHE_BYTES = 256 * 1024;
+
+struct slab_class_stats {
+    size_t blockSize = 0;
+    // bytes of slabs carved for the class
+    size_t reservedBytes = 0;
+    // bytes waiting in the global pool, blocks held by thread caches count as used
+    size_t pooledBytes = 0;
+};
+
+// Fixed size blocks for the memory chunks churn through while streaming, voxel arrays and mesh staging buffers.
+// Every thread allocates from its own cache of free blocks without locking, the global pool behind it refills
+// and drains the caches in batches. Slabs are never given back to the heap so streaming does not fragment it,
+// a block freed on another thread than the one that allocated it simply joins that thread's cache.
+class slab_pool {
+public:
+    static void *allocate(size_t size);
+    // size must be the size given to allocate
+    static void deallocate(void *pointer, size_t size);
+
+    // hands the free blocks of the calling thread to the global pool, done automatically when the thread exits
+    static void flushThreadCache();
+
+    static slab_class_stats getStats(int sizeClass);
+
+    static int getSizeClass(size_t size);
+};
+
+// Stateless allocator backed by the slab pool
+template<typename T>
+class pool_allocator {
+public:
+    using value_type = T;
+
+    pool_allocator() = default;
+
+    template<typename U>
+    pool_allocator(const pool_allocator<U> &) {
+    }
+
+    T *allocate(size_t count) {
+        return static_cast<T *>(slab_pool::allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T *pointer, size_t count) {
+        slab_pool::deallocate(pointer, count * sizeof(T));
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const pool_allocator<T> &, const pool_allocator<U> &) {
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const pool_allocator<T> &, const pool_allocator<U> &) {
+    return false;
+}
+
+template<typename T>
+using pooled_vector = std::vector<T, pool_allocator<T>>;
+
+#endif //VOXELENGINE_SLAB_POOL_H
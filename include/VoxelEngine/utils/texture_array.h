@@ -0,0 +1,43 @@
+#ifndef VOXELENGINE_TEXTURE_ARRAY_H
+#define VOXELENGINE_TEXTURE_ARRAY_H
+
+#include <glad/glad.h>
+#include "VoxelEngine/utils/bc_encoder.h"
+
+// S3TC and BPTC are extensions of the GL 3.3 core profile glad was generated for
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+GLenum getCompressedGLFormat(bc_format format);
+// checks the extension list of the current context
+bool isCompressedFormatSupported(bc_format format);
+
+// Mipmapped GL_TEXTURE_2D_ARRAY where every layer has the same size, sampled without any bleeding between layers
+class texture_array {
+public:
+    unsigned int textureID;
+    int width, height, layers;
+    // BC_FORMAT_NONE for RGBA8 storage, compressed layers are uploaded with glCompressedTexSubImage3D
+    bc_format format;
+
+    texture_array(int width, int height, int layers, bc_format format = BC_FORMAT_NONE);
+    ~texture_array();
+
+    texture_array(const texture_array &) = delete;
+    texture_array &operator=(const texture_array &) = delete;
+
+    // uploads the RGBA8 pixels of the base level of a layer, only for uncompressed arrays
+    void setLayer(int layer, const unsigned char *pixels);
+    void generateMipmaps();
+
+    void bind(unsigned int unit = 0);
+};
+
+#endif //VOXELENGINE_TEXTURE_ARRAY_H
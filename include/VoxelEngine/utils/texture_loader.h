@@ -0,0 +1,76 @@
+#ifndef VOXELENGINE_TEXTURE_LOADER_H
+#define VOXELENGINE_TEXTURE_LOADER_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "VoxelEngine/utils/compressed_texture.h"
+#include "VoxelEngine/utils/mipmap.h"
+#include "VoxelEngine/utils/texture.h"
+#include "VoxelEngine/utils/texture_array.h"
+#include "VoxelEngine/utils/thread_pool.h"
+
+// Decodes images and builds their mip chains on the thread pool, then uploads them from the GL thread through a
+// pixel buffer object so the frame never waits on disk or on the driver copy.
+// Paths ending with .vtex are cooked block compressed textures, their levels are uploaded as they are.
+class texture_loader {
+public:
+    // levels uploaded per update call, textures are uploaded whole
+    int uploadBudget = 4;
+
+    explicit texture_loader(thread_pool &pool);
+    ~texture_loader();
+
+    texture_loader(const texture_loader &) = delete;
+    texture_loader &operator=(const texture_loader &) = delete;
+
+    // the texture objects must outlive the loader or at least the upload
+    void load(const std::string &path, texture &target, bool flip = false);
+    // the image is resized to the size of the array and encoded to its format,
+    // a cooked texture must already have the size and format of the array, a mip chain stopping short of 1x1 lowers
+    // the last level sampled for the whole array
+    void load(const std::string &path, texture_array &target, int layer, bool flip = false);
+    // RGBA8 pixels of the size of the array, the mip chain and the encoding are done in the background
+    void load(std::vector<unsigned char> pixels, texture_array &target, int layer);
+
+    // uploads finished textures, must be called on the GL thread
+    void update();
+
+    // textures decoding or waiting for their upload
+    int getPendingCount();
+
+private:
+    struct request {
+        std::string path;
+        bool flip = false;
+        std::vector<unsigned char> pixels;
+
+        GLenum target = GL_TEXTURE_2D;
+        unsigned int textureID = 0;
+        int layer = 0;
+        // 0 keeps the size of the image
+        int width = 0, height = 0;
+        bc_format format = BC_FORMAT_NONE;
+
+        // with a compressed format the pixels of each level hold the encoded blocks
+        std::vector<image_level> levels;
+    };
+
+    thread_pool &pool;
+    unsigned int pbo = 0;
+
+    // decode jobs queued or running, the destructor waits for them since they reference the loader
+    std::atomic<int> jobsInFlight{0};
+    std::mutex completedMutex;
+    std::vector<std::shared_ptr<request>> completed;
+
+    void enqueue(const std::shared_ptr<request> &job);
+    static void decode(request &job);
+    static bool decodeFile(request &job);
+    void upload(const request &job);
+};
+
+#endif //VOXELENGINE_TEXTURE_LOADER_H
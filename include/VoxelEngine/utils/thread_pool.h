@@ -0,0 +1,57 @@
+#ifndef VOXELENGINE_THREAD_POOL_H
+#define VOXELENGINE_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads consuming a priority queue of jobs, jobs with the lowest priority value run first
+class thread_pool
+{
+public:
+    // 0 uses one thread per hardware thread minus the one running the render loop
+    explicit thread_pool(unsigned int threadCount = 0);
+    ~thread_pool();
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    void enqueue(std::function<void()> job, int priority = 0);
+
+    size_t getPendingCount() const;
+    unsigned int getThreadCount() const;
+
+private:
+    struct Job
+    {
+        int priority;
+        // jobs of the same priority keep their submission order
+        uint64_t order;
+        std::function<void()> run;
+    };
+
+    struct JobCompare
+    {
+        bool operator()(const Job &a, const Job &b) const
+        {
+            if (a.priority != b.priority)
+                return a.priority > b.priority;
+            return a.order > b.order;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    std::priority_queue<Job, std::vector<Job>, JobCompare> jobs;
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    uint64_t submitted = 0;
+    bool stopping = false;
+
+    void workerLoop();
+};
+
+#endif //VOXELENGINE_THREAD_POOL_H
@@ -0,0 +1,36 @@
+#ifndef VOXELENGINE_UNIFORM_BUFFER_H
+#define VOXELENGINE_UNIFORM_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+
+// binding point of the FrameData block, shaders are bound to it when they are linked
+const unsigned int FRAME_DATA_BINDING = 0;
+
+// std140 layout of the FrameData block, vec3 values are padded to vec4
+struct frame_data {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 camPos;
+    glm::vec4 lightPos;
+};
+static_assert(sizeof(frame_data) == 160, "frame_data must match the std140 layout of FrameData");
+
+// Uniform buffer object attached to a binding point, shared by every program that declares the block
+class uniform_buffer {
+public:
+    unsigned int bufferID;
+    size_t size;
+
+    uniform_buffer(size_t size, unsigned int binding);
+    ~uniform_buffer();
+
+    uniform_buffer(const uniform_buffer &) = delete;
+    uniform_buffer &operator=(const uniform_buffer &) = delete;
+
+    // replaces the whole content, the previous storage is orphaned so the driver never waits on draws still using it
+    void update(const void *data);
+};
+
+#endif //VOXELENGINE_UNIFORM_BUFFER_H
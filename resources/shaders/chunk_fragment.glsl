@@ -0,0 +1,32 @@
+#version 330 core
+
+in vec3 Normal;
+in vec3 FragPos;
+in vec2 TexCoord;
+flat in float Layer;
+out vec4 FragColor;
+
+uniform sampler2DArray blockTextures;
+
+#include "include/frame_data.glsl"
+
+#ifdef FOG
+const vec3 fogColor = vec3(0.1);
+const float fogDensity = 0.0015;
+#endif
+
+void main(){
+    // fixed per axis shading so faces stay readable without a light
+    vec3 n = abs(Normal);
+    float shade = n.y * (Normal.y > 0.0 ? 1.0 : 0.5) + n.x * 0.8 + n.z * 0.65;
+
+    vec4 color = texture(blockTextures, vec3(TexCoord, Layer));
+    vec3 result = color.rgb * shade;
+#ifdef FOG
+    // exponential squared fog towards the clear colour, hides the end of the clipmap
+    float fogDistance = length(FragPos - camPos.xyz);
+    float visibility = exp(-pow(fogDistance * fogDensity, 2.0));
+    result = mix(fogColor, result, visibility);
+#endif
+    FragColor = vec4(result, color.a);
+}
\ No newline at end of file
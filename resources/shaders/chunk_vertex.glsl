@@ -0,0 +1,22 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in float aLayer;
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 TexCoord;
+flat out float Layer;
+
+#include "include/frame_data.glsl"
+
+// chunk meshes are built directly in world space
+void main(){
+    gl_Position = projection * view * vec4(aPos, 1.0);
+    FragPos = aPos;
+    Normal = aNormal;
+    TexCoord = aTexCoord;
+    Layer = aLayer;
+}
\ No newline at end of file
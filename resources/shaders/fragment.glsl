@@ -6,12 +6,13 @@ in vec3 FragPos;
 out vec4 FragColor;
 
 uniform sampler2D ourTexture;
-uniform vec3 lightPos;
+
+#include "include/frame_data.glsl"
 
 void main(){
 
 //    vec3 norm = normalize(Normal);
-//    vec3 lightDir = normalize(lightPos - FragPos);
+//    vec3 lightDir = normalize(lightPos.xyz - FragPos);
 //
 //    float diff = max(dot(norm, lightDir), 0.0);
 //    vec3 diffuse = diff * vec3(1.0);
@@ -0,0 +1,7 @@
+// per frame values shared by every program, must match frame_data in uniform_buffer.h
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 camPos;
+    vec4 lightPos;
+};
\ No newline at end of file
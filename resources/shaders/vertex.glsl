@@ -9,8 +9,8 @@ out vec3 Normal;
 out vec3 FragPos;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+#include "include/frame_data.glsl"
 
 void main(){
     gl_Position = projection * view * modelMatrix  * vec4(aPos, 1.0);
@@ -0,0 +1,80 @@
+#include "VoxelEngine/components/block_registry.h"
+#include "VoxelEngine/components/chunk.h"
+#include "VoxelEngine/utils/file_watcher.h"
+#include "VoxelEngine/utils/texture_loader.h"
+#include <algorithm>
+
+BlockRegistry::BlockRegistry() {
+    blocks.push_back({"air", {0, 0, 0, 0, 0, 0}});
+}
+
+int BlockRegistry::registerMaterial(const std::string &name, const glm::vec4 &color, const std::string &texturePath) {
+    materials.push_back({name, color, texturePath});
+    return static_cast<int>(materials.size() - 1);
+}
+
+uint8_t BlockRegistry::registerBlock(const std::string &name, int material) {
+    return registerBlock(name, material, material, material);
+}
+
+uint8_t BlockRegistry::registerBlock(const std::string &name, int top, int side, int bottom) {
+    BlockType block;
+    block.name = name;
+    for (int face = 0; face < 6; face++)
+        block.faceLayers[face] = static_cast<uint16_t>(side);
+    block.faceLayers[FACE_POS_Y] = static_cast<uint16_t>(top);
+    block.faceLayers[FACE_NEG_Y] = static_cast<uint16_t>(bottom);
+    blocks.push_back(block);
+    return static_cast<uint8_t>(blocks.size() - 1);
+}
+
+// registration order must follow Block_Id
+void BlockRegistry::registerDefaults() {
+    int grassTop = registerMaterial("grass_top", glm::vec4(0.36, 0.76, 0.4, 1.0));
+    int grassSide = registerMaterial("grass_side", glm::vec4(0.45, 0.55, 0.3, 1.0));
+    int dirt = registerMaterial("dirt", glm::vec4(0.5, 0.36, 0.24, 1.0));
+    int stone = registerMaterial("stone", glm::vec4(0.5, 0.5, 0.52, 1.0));
+
+    registerBlock("grass", grassTop, grassSide, dirt);
+    registerBlock("dirt", dirt);
+    registerBlock("stone", stone);
+}
+
+void BlockRegistry::watchTextures(file_watcher &watcher, texture_loader &loader) {
+    for (size_t layer = 0; layer < materials.size(); layer++) {
+        const std::string &path = materials[layer].texturePath;
+        if (path.empty())
+            continue;
+        int index = static_cast<int>(layer);
+        watcher.watch({path}, [this, &loader, path, index]() {
+            if (textures)
+                loader.load(path, *textures, index);
+        });
+    }
+}
+
+void BlockRegistry::buildTextures(int resolution, texture_loader &loader, bc_format format) {
+    textures.reset(new texture_array(resolution, resolution, std::max(1, static_cast<int>(materials.size())), format));
+
+    for (size_t layer = 0; layer < materials.size(); layer++) {
+        const BlockMaterial &material = materials[layer];
+        if (!material.texturePath.empty()) {
+            loader.load(material.texturePath, *textures, static_cast<int>(layer));
+            continue;
+        }
+
+        std::vector<unsigned char> pixels(resolution * resolution * 4);
+        for (int y = 0; y < resolution; y++) {
+            for (int x = 0; x < resolution; x++) {
+                unsigned char *pixel = &pixels[(x + y * resolution) * 4];
+                // slight per pixel variation so unicolor blocks don't look flat
+                unsigned int hash = (x * 73856093u) ^ (y * 19349663u) ^ (static_cast<unsigned int>(layer) * 83492791u);
+                float shade = 0.9f + 0.1f * static_cast<float>(hash % 256u) / 255.0f;
+                for (int c = 0; c < 3; c++)
+                    pixel[c] = static_cast<unsigned char>(std::min(1.0f, material.color[c] * shade) * 255.0f);
+                pixel[3] = static_cast<unsigned char>(material.color.a * 255.0f);
+            }
+        }
+        loader.load(std::move(pixels), *textures, static_cast<int>(layer));
+    }
+}
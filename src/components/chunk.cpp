@@ -0,0 +1,363 @@
+#include "VoxelEngine/components/chunk.h"
+#include "VoxelEngine/components/block_registry.h"
+#include "VoxelEngine/utils/frame_arena.h"
+#include "VoxelEngine/utils/memory_tracker.h"
+#include "VoxelEngine/utils/profiler.h"
+#include <algorithm>
+
+namespace {
+    // corners of each face, counter-clockwise when seen from outside the voxel
+    const float FACE_CORNERS[6][4][3] = {
+            {{0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0}}, // -X
+            {{1, 0, 0}, {1, 1, 0}, {1, 1, 1}, {1, 0, 1}}, // +X
+            {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}}, // -Y
+            {{0, 1, 0}, {0, 1, 1}, {1, 1, 1}, {1, 1, 0}}, // +Y
+            {{0, 0, 0}, {0, 1, 0}, {1, 1, 0}, {1, 0, 0}}, // -Z
+            {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}}  // +Z
+    };
+    const float CORNER_UVS[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    const int VERTEX_FLOATS = 9;
+
+    template<typename Indices>
+    void addFace(ChunkMesh &mesh, Indices &indices, const glm::vec3 &origin, int face, float scale, float layer) {
+        unsigned int base = static_cast<unsigned int>(mesh.vertices.size() / VERTEX_FLOATS);
+        for (int c = 0; c < 4; c++) {
+            mesh.vertices.push_back(origin.x + FACE_CORNERS[face][c][0] * scale);
+            mesh.vertices.push_back(origin.y + FACE_CORNERS[face][c][1] * scale);
+            mesh.vertices.push_back(origin.z + FACE_CORNERS[face][c][2] * scale);
+            mesh.vertices.push_back(static_cast<float>(FACE_OFFSETS[face].x));
+            mesh.vertices.push_back(static_cast<float>(FACE_OFFSETS[face].y));
+            mesh.vertices.push_back(static_cast<float>(FACE_OFFSETS[face].z));
+            // merged voxels repeat the texture once per voxel
+            mesh.vertices.push_back(CORNER_UVS[c][0] * scale);
+            mesh.vertices.push_back(CORNER_UVS[c][1] * scale);
+            mesh.vertices.push_back(layer);
+        }
+        // clockwise winding, the renderer culls GL_FRONT like Cube does
+        unsigned int quad[6] = {base, base + 2, base + 1, base, base + 3, base + 2};
+        indices.insert(indices.end(), quad, quad + 6);
+    }
+}
+
+// ChunkMesh
+// ------------------------------------------------------------------------
+void ChunkMesh::upload() {
+    indexCount = static_cast<GLsizei>(indices.size());
+    if (indexCount == 0) {
+        release();
+        return;
+    }
+
+    if (VAO == 0) {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+    }
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    memory_tracker::trackGPU(GPU_BUFFER, VBO, MEMORY_MESHES, vertices.size() * sizeof(float));
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    memory_tracker::trackGPU(GPU_BUFFER, EBO, MEMORY_MESHES, indices.size() * sizeof(unsigned int));
+
+    // Position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    // Normal attribute
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    // Texture coordinate attribute
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    // Texture array layer attribute
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(8 * sizeof(float)));
+    glEnableVertexAttribArray(3);
+
+    glBindVertexArray(0);
+
+    // the GPU owns the data from now on
+    pooled_vector<float>().swap(vertices);
+    pooled_vector<unsigned int>().swap(indices);
+}
+
+void ChunkMesh::draw(uint8_t skirtMask) const {
+    if (indexCount == 0)
+        return;
+    glBindVertexArray(VAO);
+
+    GLsizei counts[7] = {surfaceCount};
+    const void *offsets[7] = {nullptr};
+    GLsizei drawCount = 1;
+    for (int face = 0; face < 6; face++) {
+        if ((skirtMask & (1 << face)) && skirtCount[face] > 0) {
+            counts[drawCount] = skirtCount[face];
+            offsets[drawCount] = (void*)(skirtOffset[face] * sizeof(unsigned int));
+            drawCount++;
+        }
+    }
+
+    if (drawCount == 1)
+        glDrawElements(GL_TRIANGLES, surfaceCount, GL_UNSIGNED_INT, 0);
+    else
+        glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_INT, offsets, drawCount);
+}
+
+void ChunkMesh::release() {
+    if (VAO != 0) {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        memory_tracker::releaseGPU(GPU_BUFFER, VBO);
+        memory_tracker::releaseGPU(GPU_BUFFER, EBO);
+    }
+    VAO = VBO = EBO = 0;
+    indexCount = 0;
+    surfaceCount = 0;
+}
+
+// ChunkVoxels
+// ------------------------------------------------------------------------
+ChunkVoxels::ChunkVoxels() {
+    MEMORY_SCOPE(MEMORY_CHUNKS);
+    storage = std::make_shared<ChunkVoxelArray>(CHUNK_VOLUME, BLOCK_AIR);
+}
+
+void ChunkVoxels::detach() {
+    MEMORY_SCOPE(MEMORY_CHUNKS);
+    storage = std::make_shared<ChunkVoxelArray>(*storage);
+}
+
+// Chunk
+// ------------------------------------------------------------------------
+Chunk::Chunk(const glm::ivec3 &position, int scale)
+        : position(position), scale(scale), visitedFrame(0) {
+    connectivity.fill(0x3F);
+}
+
+Chunk::~Chunk() {
+    for (ChunkMesh &mesh : meshes)
+        mesh.release();
+}
+
+glm::vec3 Chunk::getMin() const {
+    return glm::vec3(position * CHUNK_SIZE * scale);
+}
+
+glm::vec3 Chunk::getMax() const {
+    return glm::vec3((position + 1) * CHUNK_SIZE * scale);
+}
+
+uint8_t Chunk::getLodVoxel(int lod, int x, int y, int z) const {
+    if (lod == 0)
+        return getVoxel(x, y, z);
+
+    int step = 1 << lod;
+    int solid = 0;
+    uint8_t top = 0;
+    // scan from the top so merged surfaces keep the id of their upper voxels
+    for (int dy = step - 1; dy >= 0; dy--) {
+        for (int dz = 0; dz < step; dz++) {
+            for (int dx = 0; dx < step; dx++) {
+                uint8_t id = getVoxel(x * step + dx, y * step + dy, z * step + dz);
+                if (id != 0) {
+                    solid++;
+                    if (top == 0)
+                        top = id;
+                }
+            }
+        }
+    }
+    return solid * 2 >= step * step * step ? top : 0;
+}
+
+int Chunk::getSolidCount() const {
+    return CHUNK_VOLUME - static_cast<int>(std::count(voxels.begin(), voxels.end(), BLOCK_AIR));
+}
+
+bool Chunk::isFaceSolid(int face, int depth) const {
+    int axis = face / 2;
+    for (int layer = 0; layer < depth; layer++) {
+        glm::ivec3 p;
+        p[axis] = (face & 1) ? CHUNK_SIZE - 1 - layer : layer;
+        for (int a = 0; a < CHUNK_SIZE; a++) {
+            for (int b = 0; b < CHUNK_SIZE; b++) {
+                p[(axis + 1) % 3] = a;
+                p[(axis + 2) % 3] = b;
+                if (getVoxel(p.x, p.y, p.z) == BLOCK_AIR)
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Chunk::buildMesh(const Chunk *const neighbours[6], const BlockRegistry &registry, uint8_t lodMask) {
+    PROFILE_SCOPE("Chunk mesh");
+    MEMORY_SCOPE(MEMORY_MESHES);
+
+    // most sections of a tall world are open air or buried rock, neither has a surface to mesh. The neighbours of a
+    // buried one must be solid as deep as the coarsest level and the skirts look into them. Every level meshed
+    // the long way would come out empty too, so the levels left untouched by a partial remesh stay valid
+    int solid = getSolidCount();
+    bool buried = solid == CHUNK_VOLUME;
+    for (int face = 0; face < 6 && buried; face++)
+        buried = neighbours[face] != nullptr && neighbours[face]->isFaceSolid(oppositeFace(face), CHUNK_SKIRT_DEPTH);
+    if (solid == 0 || buried) {
+        for (int lod = 0; lod < CHUNK_LOD_COUNT; lod++) {
+            if ((lodMask & (1 << lod)) == 0)
+                continue;
+            ChunkMesh &mesh = meshes[lod];
+            mesh.vertices.clear();
+            mesh.indices.clear();
+            mesh.surfaceCount = 0;
+            std::fill(mesh.skirtOffset, mesh.skirtOffset + 6, 0);
+            std::fill(mesh.skirtCount, mesh.skirtCount + 6, 0);
+        }
+        connectivity.fill(solid == 0 ? 0x3F : 0);
+        return;
+    }
+
+    for (int lod = 0; lod < CHUNK_LOD_COUNT; lod++) {
+        if (lodMask & (1 << lod))
+            buildLodMesh(lod, neighbours, registry);
+    }
+
+    computeConnectivity();
+}
+
+void Chunk::buildLodMesh(int lod, const Chunk *const neighbours[6], const BlockRegistry &registry) {
+    ChunkMesh &mesh = meshes[lod];
+    mesh.vertices.clear();
+    mesh.indices.clear();
+
+    const int step = 1 << lod;
+    const int size = CHUNK_SIZE >> lod;
+    const int skirtCells = std::max(1, CHUNK_SKIRT_DEPTH / step);
+
+    // meshing runs on the pool workers, its temporaries live in the worker's scratch arena
+    scratch_scope scratch;
+    arena_vector<uint8_t> grid(size * size * size, 0, scratch_arena::allocator<uint8_t>());
+    for (int z = 0; z < size; z++)
+        for (int y = 0; y < size; y++)
+            for (int x = 0; x < size; x++)
+                grid[x + size * (y + size * z)] = getLodVoxel(lod, x, y, z);
+
+    // samples the downsampled grid, stepping at most one chunk out along a single axis
+    auto sample = [&](const glm::ivec3 &p) -> uint8_t {
+        int face = -1;
+        if (p.x < 0) face = FACE_NEG_X;
+        else if (p.x >= size) face = FACE_POS_X;
+        else if (p.y < 0) face = FACE_NEG_Y;
+        else if (p.y >= size) face = FACE_POS_Y;
+        else if (p.z < 0) face = FACE_NEG_Z;
+        else if (p.z >= size) face = FACE_POS_Z;
+
+        if (face < 0)
+            return grid[p.x + size * (p.y + size * p.z)];
+        if (neighbours[face] == nullptr)
+            return 0;
+        glm::ivec3 wrapped = (p + size) % size;
+        return neighbours[face]->getLodVoxel(lod, wrapped.x, wrapped.y, wrapped.z);
+    };
+
+    arena_allocator<unsigned int> indexAllocator = scratch_arena::allocator<unsigned int>();
+    arena_vector<unsigned int> skirts[6] = {
+            arena_vector<unsigned int>(indexAllocator), arena_vector<unsigned int>(indexAllocator),
+            arena_vector<unsigned int>(indexAllocator), arena_vector<unsigned int>(indexAllocator),
+            arena_vector<unsigned int>(indexAllocator), arena_vector<unsigned int>(indexAllocator)};
+    glm::vec3 origin = getMin();
+    for (int z = 0; z < size; z++) {
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                glm::ivec3 cell(x, y, z);
+                uint8_t id = grid[x + size * (y + size * z)];
+                if (id == 0)
+                    continue;
+
+                glm::vec3 cellOrigin = origin + glm::vec3(cell * step * scale);
+                for (int face = 0; face < 6; face++) {
+                    glm::ivec3 n = cell + FACE_OFFSETS[face];
+                    float layer = static_cast<float>(registry.getFaceLayer(id, face));
+                    if (sample(n) == 0) {
+                        addFace(mesh, mesh.indices, cellOrigin, face, static_cast<float>(step * scale), layer);
+                        continue;
+                    }
+
+                    bool border = n.x < 0 || n.x >= size || n.y < 0 || n.y >= size || n.z < 0 || n.z >= size;
+                    if (!border)
+                        continue;
+
+                    // hidden border faces close to the surface become skirts, they cover the
+                    // cracks left when the neighbour is drawn with a different level of detail
+                    for (int k = 1; k <= skirtCells; k++) {
+                        if (sample(cell + glm::ivec3(0, k, 0)) == 0) {
+                            addFace(mesh, skirts[face], cellOrigin, face, static_cast<float>(step * scale), layer);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    mesh.surfaceCount = static_cast<GLsizei>(mesh.indices.size());
+    for (int face = 0; face < 6; face++) {
+        mesh.skirtOffset[face] = static_cast<GLsizei>(mesh.indices.size());
+        mesh.skirtCount[face] = static_cast<GLsizei>(skirts[face].size());
+        mesh.indices.insert(mesh.indices.end(), skirts[face].begin(), skirts[face].end());
+    }
+}
+
+// flood fills every air region of the chunk and records which faces each region touches,
+// all the faces touched by the same region can see each other
+void Chunk::computeConnectivity() {
+    connectivity.fill(0);
+
+    scratch_scope scratch;
+    arena_vector<uint8_t> visited(CHUNK_VOLUME, 0, scratch_arena::allocator<uint8_t>());
+    arena_vector<int> stack(scratch_arena::allocator<int>());
+    stack.reserve(CHUNK_VOLUME);
+
+    for (int start = 0; start < CHUNK_VOLUME; start++) {
+        if (visited[start] || voxels[start] != 0)
+            continue;
+
+        uint8_t touched = 0;
+        visited[start] = 1;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            int i = stack.back();
+            stack.pop_back();
+            int x = i % CHUNK_SIZE;
+            int y = (i / CHUNK_SIZE) % CHUNK_SIZE;
+            int z = i / (CHUNK_SIZE * CHUNK_SIZE);
+
+            if (x == 0) touched |= 1 << FACE_NEG_X;
+            if (x == CHUNK_SIZE - 1) touched |= 1 << FACE_POS_X;
+            if (y == 0) touched |= 1 << FACE_NEG_Y;
+            if (y == CHUNK_SIZE - 1) touched |= 1 << FACE_POS_Y;
+            if (z == 0) touched |= 1 << FACE_NEG_Z;
+            if (z == CHUNK_SIZE - 1) touched |= 1 << FACE_POS_Z;
+
+            for (int face = 0; face < 6; face++) {
+                glm::ivec3 n = glm::ivec3(x, y, z) + FACE_OFFSETS[face];
+                if (n.x < 0 || n.x >= CHUNK_SIZE || n.y < 0 || n.y >= CHUNK_SIZE || n.z < 0 || n.z >= CHUNK_SIZE)
+                    continue;
+                int j = index(n.x, n.y, n.z);
+                if (!visited[j] && voxels[j] == 0) {
+                    visited[j] = 1;
+                    stack.push_back(j);
+                }
+            }
+        }
+
+        for (int face = 0; face < 6; face++) {
+            if (touched & (1 << face))
+                connectivity[face] |= touched;
+        }
+    }
+}
@@ -0,0 +1,245 @@
+#include "VoxelEngine/components/clipmap.h"
+#include "VoxelEngine/utils/frame_arena.h"
+#include "VoxelEngine/utils/frustum.h"
+#include "VoxelEngine/utils/profiler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // nearest even integer, keeps ring borders aligned on the cells of the next ring
+    int roundToEven(float value) {
+        return 2 * static_cast<int>(std::floor(value * 0.5f + 0.5f));
+    }
+}
+
+Clipmap::Clipmap(thread_pool &pool, const BlockRegistry &registry, int ringCount, int firstScale,
+                 const glm::ivec3 &halfExtent)
+        : halfExtent(halfExtent), pool(pool), registry(registry) {
+    rings.resize(ringCount);
+    for (int i = 0; i < ringCount; i++) {
+        rings[i].scale = firstScale << i;
+        rings[i].center = glm::ivec3(0);
+    }
+}
+
+Clipmap::~Clipmap() {
+    for (ClipmapRing &ring : rings)
+        for (auto &entry : ring.cells)
+            entry.second->cancelled = true;
+    // cancelled jobs return immediately, wait until none of them can touch the clipmap anymore
+    while (jobsInFlight.load() > 0)
+        std::this_thread::yield();
+}
+
+void Clipmap::setDetailRegion(const glm::vec3 &min, const glm::vec3 &max) {
+    detailMin = min;
+    detailMax = max;
+    dirty = true;
+}
+
+bool Clipmap::isInRing(int ring, const glm::ivec3 &cell) const {
+    const ClipmapRing &current = rings[ring];
+    glm::ivec3 local = cell - current.center;
+    if (glm::any(glm::lessThan(local, -halfExtent)) || glm::any(glm::greaterThanEqual(local, halfExtent)))
+        return false;
+
+    if (ring > 0) {
+        // the hole left for the inner ring, its bounds are even so they map exactly onto this ring's cells
+        const ClipmapRing &inner = rings[ring - 1];
+        glm::ivec3 holeMin = (inner.center - halfExtent) / 2;
+        glm::ivec3 holeMax = (inner.center + halfExtent) / 2;
+        if (glm::all(glm::greaterThanEqual(cell, holeMin)) && glm::all(glm::lessThan(cell, holeMax)))
+            return false;
+    }
+
+    float size = static_cast<float>(CHUNK_SIZE * current.scale);
+    glm::vec3 min = glm::vec3(cell) * size;
+    glm::vec3 max = min + size;
+    return !(glm::all(glm::greaterThanEqual(min, detailMin)) && glm::all(glm::lessThanEqual(max, detailMax)));
+}
+
+bool Clipmap::intersectsDetail(const glm::vec3 &min, const glm::vec3 &max) const {
+    return glm::all(glm::lessThan(detailMin, detailMax)) && glm::all(glm::lessThan(min, detailMax)) &&
+           glm::all(glm::greaterThan(max, detailMin));
+}
+
+// the detail region is made of World chunks, halving down to scale 1 always ends on chunks fully in or out of it
+void Clipmap::addChunks(ClipmapCell &cell, const glm::ivec3 &position, int scale) const {
+    glm::vec3 min = glm::vec3(position * CHUNK_SIZE * scale);
+    glm::vec3 max = min + static_cast<float>(CHUNK_SIZE * scale);
+    if (!intersectsDetail(min, max)) {
+        cell.chunks.emplace_back(new Chunk(position, scale));
+        return;
+    }
+    if (scale % 2 != 0)
+        return;
+    for (int i = 0; i < 8; i++)
+        addChunks(cell, position * 2 + glm::ivec3(i & 1, (i >> 1) & 1, i >> 2), scale / 2);
+}
+
+void Clipmap::update(const glm::vec3 &cameraPosition) {
+    PROFILE_SCOPE("Clipmap update");
+    // upload what the workers finished, within the budget
+    arena_vector<std::shared_ptr<ClipmapCell>> finished(frame_arena::allocator<std::shared_ptr<ClipmapCell>>());
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        size_t count = std::min(completed.size(), static_cast<size_t>(uploadBudget));
+        finished.assign(completed.begin(), completed.begin() + count);
+        completed.erase(completed.begin(), completed.begin() + count);
+    }
+    for (const std::shared_ptr<ClipmapCell> &cell : finished) {
+        if (cell->cancelled)
+            continue;
+        for (const std::unique_ptr<Chunk> &chunk : cell->chunks)
+            chunk->meshes[0].upload();
+        cell->ready = true;
+    }
+
+    // recentre the rings from the inside out
+    arena_vector<bool> moved(rings.size(), false, frame_arena::allocator<bool>());
+    for (size_t i = 0; i < rings.size(); i++) {
+        glm::ivec3 center;
+        if (i == 0) {
+            glm::vec3 cell = cameraPosition / static_cast<float>(CHUNK_SIZE * rings[0].scale);
+            center = glm::ivec3(roundToEven(cell.x), roundToEven(cell.y), roundToEven(cell.z));
+        } else {
+            glm::vec3 inner = glm::vec3(rings[i - 1].center) * 0.5f;
+            center = glm::ivec3(roundToEven(inner.x), roundToEven(inner.y), roundToEven(inner.z));
+        }
+        moved[i] = dirty || center != rings[i].center || !rings[i].initialized;
+        rings[i].center = center;
+    }
+
+    // a ring also changes when the hole of its inner ring moves
+    for (size_t i = 0; i < rings.size(); i++) {
+        if (moved[i] || (i > 0 && moved[i - 1]))
+            updateRing(static_cast<int>(i), cameraPosition);
+        rings[i].initialized = true;
+    }
+    dirty = false;
+}
+
+void Clipmap::updateRing(int ringIndex, const glm::vec3 &cameraPosition) {
+    ClipmapRing &ring = rings[ringIndex];
+
+    for (auto it = ring.cells.begin(); it != ring.cells.end();) {
+        if (!isInRing(ringIndex, it->first)) {
+            it->second->cancelled = true;
+            it = ring.cells.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    glm::vec3 cameraCell = cameraPosition / static_cast<float>(CHUNK_SIZE * ring.scale);
+    glm::ivec3 min = ring.center - halfExtent;
+    glm::ivec3 max = ring.center + halfExtent;
+    for (int x = min.x; x < max.x; x++) {
+        for (int y = min.y; y < max.y; y++) {
+            for (int z = min.z; z < max.z; z++) {
+                glm::ivec3 position(x, y, z);
+                if (ring.cells.count(position) != 0 || !isInRing(ringIndex, position))
+                    continue;
+
+                std::shared_ptr<ClipmapCell> cell = std::make_shared<ClipmapCell>();
+                addChunks(*cell, position, ring.scale);
+                cell->split = cell->chunks.size() != 1 || cell->chunks[0]->scale != ring.scale;
+                ring.cells[position] = cell;
+
+                // inner rings first, then closest cells first
+                glm::vec3 offset = glm::vec3(position) + 0.5f - cameraCell;
+                int priority = (ringIndex << 20) + static_cast<int>(glm::dot(offset, offset));
+
+                jobsInFlight++;
+                pool.enqueue([this, cell]() mutable {
+                    if (!cell->cancelled) {
+                        buildCell(*cell);
+                        std::lock_guard<std::mutex> lock(completedMutex);
+                        completed.push_back(cell);
+                    }
+                    // an uploaded cell must only be destroyed on the GL thread
+                    cell.reset();
+                    jobsInFlight--;
+                }, priority);
+            }
+        }
+    }
+
+    for (auto &entry : ring.cells) {
+        if (entry.second->split) {
+            entry.second->skirtMask = 0x3F;
+            continue;
+        }
+        uint8_t mask = 0;
+        for (int face = 0; face < 6; face++) {
+            if (ring.cells.count(entry.first + FACE_OFFSETS[face]) == 0)
+                mask |= 1 << face;
+        }
+        entry.second->skirtMask = mask;
+    }
+}
+
+// runs on a worker, the neighbours are only generated on the layers the mesher looks at
+void Clipmap::buildCell(ClipmapCell &cell) {
+    PROFILE_SCOPE("Clipmap cell");
+    for (const std::unique_ptr<Chunk> &chunk : cell.chunks)
+        buildChunk(*chunk);
+}
+
+void Clipmap::buildChunk(Chunk &chunk) {
+    generator.fill(chunk);
+    // the sky above the terrain needs neither the border layers nor a mesh
+    if (chunk.getSolidCount() == 0)
+        return;
+
+    std::unique_ptr<Chunk> borders[6];
+    const Chunk *neighbours[6];
+    for (int face = 0; face < 6; face++) {
+        borders[face].reset(new Chunk(chunk.position + FACE_OFFSETS[face], chunk.scale));
+
+        int axis = face / 2;
+        glm::ivec3 min(0), max(CHUNK_SIZE);
+        if (face & 1)
+            max[axis] = face == FACE_POS_Y ? CHUNK_SKIRT_DEPTH : 1;
+        else
+            min[axis] = CHUNK_SIZE - 1;
+
+        generator.fill(*borders[face], min, max);
+        neighbours[face] = borders[face].get();
+    }
+
+    // coarse chunks are already their own level of detail
+    chunk.buildMesh(neighbours, registry, 1 << 0);
+}
+
+void Clipmap::draw(const glm::mat4 &viewProjection) {
+    PROFILE_SCOPE("Clipmap draw");
+    frustum frustum(viewProjection);
+    drawnChunks = 0;
+    for (const ClipmapRing &ring : rings) {
+        for (const auto &entry : ring.cells) {
+            const ClipmapCell &cell = *entry.second;
+            if (!cell.ready)
+                continue;
+            for (const std::unique_ptr<Chunk> &chunk : cell.chunks) {
+                if (chunk->meshes[0].indexCount == 0 || !frustum.isBoxVisible(chunk->getMin(), chunk->getMax()))
+                    continue;
+                chunk->meshes[0].draw(cell.skirtMask);
+                drawnChunks++;
+            }
+        }
+    }
+    glBindVertexArray(0);
+}
+
+size_t Clipmap::getChunkCount() const {
+    size_t count = 0;
+    for (const ClipmapRing &ring : rings)
+        for (const auto &entry : ring.cells)
+            count += entry.second->chunks.size();
+    return count;
+}
+
+int Clipmap::getPendingCount() const {
+    return jobsInFlight.load();
+}
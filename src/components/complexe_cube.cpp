@@ -1,4 +1,5 @@
 #include "VoxelEngine/components/complexe_cube.h"
+#include "VoxelEngine/utils/memory_tracker.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
@@ -60,6 +61,14 @@ ComplexeCube::ComplexeCube(float size, GLuint textureID)
     setupMesh();
 }
 
+ComplexeCube::~ComplexeCube() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    memory_tracker::releaseGPU(GPU_BUFFER, VBO);
+    memory_tracker::releaseGPU(GPU_BUFFER, EBO);
+}
+
 void ComplexeCube::setupMesh() {
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
@@ -69,9 +78,11 @@ void ComplexeCube::setupMesh() {
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+    memory_tracker::trackGPU(GPU_BUFFER, VBO, MEMORY_RENDERING, vertices.size() * sizeof(float));
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    memory_tracker::trackGPU(GPU_BUFFER, EBO, MEMORY_RENDERING, indices.size() * sizeof(unsigned int));
 
     // Position attribute
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
@@ -0,0 +1,269 @@
+#include "VoxelEngine/components/edit_journal.h"
+#include "VoxelEngine/components/chunk.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+    void writeValue(std::ofstream &file, uint32_t value) {
+        unsigned char bytes[4] = {static_cast<unsigned char>(value), static_cast<unsigned char>(value >> 8),
+                                  static_cast<unsigned char>(value >> 16), static_cast<unsigned char>(value >> 24)};
+        file.write(reinterpret_cast<const char *>(bytes), 4);
+    }
+
+    bool readValue(std::ifstream &file, uint32_t &value) {
+        unsigned char bytes[4];
+        if (!file.read(reinterpret_cast<char *>(bytes), 4))
+            return false;
+        value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+        return true;
+    }
+
+    size_t getDeltaBytes(const ChunkDelta &delta) {
+        return sizeof(ChunkDelta) + delta.palette.capacity() + delta.runs.capacity();
+    }
+}
+
+void EditJournal::beginStep() {
+    depth++;
+}
+
+void EditJournal::endStep() {
+    if (depth == 0 || --depth > 0)
+        return;
+    if (current.deltas.empty())
+        return;
+
+    // a new edit makes the undone steps unreachable
+    for (const EditStep &step : redoSteps)
+        memoryUsage -= step.bytes;
+    redoSteps.clear();
+
+    memoryUsage += current.bytes;
+    undoSteps.push_back(std::move(current));
+    current = EditStep();
+    trim();
+}
+
+bool EditJournal::isRecording() const {
+    return depth > 0;
+}
+
+void EditJournal::beginChunk(const glm::ivec3 &position) {
+    chunk.position = position;
+    chunk.palette.clear();
+    chunk.runs.clear();
+    chunkOpen = true;
+    runLength = 0;
+    previousEnd = 0;
+}
+
+void EditJournal::recordChange(int index, uint8_t previous, uint8_t id) {
+    // edits usually write few distinct pairs, the last one is the likeliest
+    size_t entry = runLength > 0 ? runEntry : 0;
+    if (chunk.palette.size() <= entry * 2 || chunk.palette[entry * 2] != previous ||
+        chunk.palette[entry * 2 + 1] != id) {
+        entry = 0;
+        while (entry * 2 < chunk.palette.size() &&
+               (chunk.palette[entry * 2] != previous || chunk.palette[entry * 2 + 1] != id))
+            entry++;
+        if (entry * 2 == chunk.palette.size()) {
+            chunk.palette.push_back(previous);
+            chunk.palette.push_back(id);
+        }
+    }
+
+    if (runLength > 0 && entry == runEntry && index == runStart + runLength) {
+        runLength++;
+        return;
+    }
+    flushRun();
+    runStart = index;
+    runLength = 1;
+    runEntry = entry;
+}
+
+void EditJournal::flushRun() {
+    if (runLength == 0)
+        return;
+    writeVarint(chunk.runs, static_cast<size_t>(runStart - previousEnd));
+    writeVarint(chunk.runs, static_cast<size_t>(runLength));
+    writeVarint(chunk.runs, runEntry);
+    current.voxelCount += static_cast<size_t>(runLength);
+    previousEnd = runStart + runLength;
+    runLength = 0;
+}
+
+const ChunkDelta *EditJournal::endChunk() {
+    if (!chunkOpen)
+        return nullptr;
+    flushRun();
+    chunkOpen = false;
+    if (chunk.runs.empty())
+        return nullptr;
+
+    chunk.palette.shrink_to_fit();
+    chunk.runs.shrink_to_fit();
+    current.bytes += getDeltaBytes(chunk);
+    current.deltas.push_back(std::move(chunk));
+    chunk = ChunkDelta();
+    return &current.deltas.back();
+}
+
+void EditJournal::writeVarint(std::vector<uint8_t> &bytes, size_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+void EditJournal::trim() {
+    // the newest step is kept even when it is over the limit on its own
+    while (memoryUsage > memoryLimit && undoSteps.size() > 1) {
+        memoryUsage -= undoSteps.front().bytes;
+        undoSteps.pop_front();
+    }
+}
+
+bool EditJournal::isValidDelta(const ChunkDelta &delta) {
+    if (delta.palette.empty() || delta.palette.size() % 2 != 0)
+        return false;
+    size_t offset = 0, entries = delta.palette.size() / 2;
+    size_t index = 0;
+    while (offset < delta.runs.size()) {
+        size_t skip = 0, length = 0, entry = 0;
+        for (size_t *value : {&skip, &length, &entry}) {
+            int shift = 0;
+            while (true) {
+                if (offset >= delta.runs.size() || shift > 28)
+                    return false;
+                uint8_t byte = delta.runs[offset++];
+                *value |= static_cast<size_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                    break;
+                shift += 7;
+            }
+        }
+        index += skip + length;
+        if (entry >= entries || index > static_cast<size_t>(CHUNK_VOLUME))
+            return false;
+    }
+    return true;
+}
+
+const EditStep *EditJournal::undo() {
+    if (undoSteps.empty() || depth > 0)
+        return nullptr;
+    redoSteps.push_back(std::move(undoSteps.back()));
+    undoSteps.pop_back();
+    return &redoSteps.back();
+}
+
+const EditStep *EditJournal::redo() {
+    if (redoSteps.empty() || depth > 0)
+        return nullptr;
+    undoSteps.push_back(std::move(redoSteps.back()));
+    redoSteps.pop_back();
+    return &undoSteps.back();
+}
+
+size_t EditJournal::getUndoCount() const {
+    return undoSteps.size();
+}
+
+size_t EditJournal::getRedoCount() const {
+    return redoSteps.size();
+}
+
+size_t EditJournal::getMemoryUsage() const {
+    return memoryUsage;
+}
+
+void EditJournal::clear() {
+    undoSteps.clear();
+    redoSteps.clear();
+    memoryUsage = 0;
+}
+
+bool EditJournal::save(const std::string &path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cout << "ERROR::EDIT_JOURNAL::FILE_NOT_WRITTEN: " << path << std::endl;
+        return false;
+    }
+
+    file.write("VJRN", 4);
+    writeValue(file, EDIT_JOURNAL_VERSION);
+    writeValue(file, static_cast<uint32_t>(undoSteps.size()));
+    for (const EditStep &step : undoSteps) {
+        writeValue(file, static_cast<uint32_t>(step.deltas.size()));
+        for (const ChunkDelta &delta : step.deltas) {
+            for (int axis = 0; axis < 3; axis++)
+                writeValue(file, static_cast<uint32_t>(delta.position[axis]));
+            writeValue(file, static_cast<uint32_t>(delta.palette.size()));
+            file.write(reinterpret_cast<const char *>(delta.palette.data()), delta.palette.size());
+            writeValue(file, static_cast<uint32_t>(delta.runs.size()));
+            file.write(reinterpret_cast<const char *>(delta.runs.data()), delta.runs.size());
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+bool EditJournal::load(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    uint32_t version, stepCount;
+    if (!file.read(magic, 4) || std::memcmp(magic, "VJRN", 4) != 0 || !readValue(file, version) ||
+        version != EDIT_JOURNAL_VERSION || !readValue(file, stepCount)) {
+        std::cout << "ERROR::EDIT_JOURNAL::INVALID_FILE: " << path << std::endl;
+        return false;
+    }
+
+    std::deque<EditStep> steps;
+    size_t bytes = 0;
+    for (uint32_t i = 0; i < stepCount; i++) {
+        EditStep step;
+        uint32_t deltaCount;
+        if (!readValue(file, deltaCount)) {
+            std::cout << "ERROR::EDIT_JOURNAL::TRUNCATED: " << path << std::endl;
+            return false;
+        }
+        for (uint32_t d = 0; d < deltaCount; d++) {
+            ChunkDelta delta;
+            uint32_t coordinates[3], paletteSize, runSize;
+            bool valid = readValue(file, coordinates[0]) && readValue(file, coordinates[1]) &&
+                         readValue(file, coordinates[2]) && readValue(file, paletteSize) && paletteSize <= 512;
+            if (valid) {
+                delta.palette.resize(paletteSize);
+                valid = file.read(reinterpret_cast<char *>(delta.palette.data()), paletteSize) &&
+                        readValue(file, runSize) && runSize <= 16 * CHUNK_VOLUME;
+            }
+            if (valid) {
+                delta.runs.resize(runSize);
+                valid = file.read(reinterpret_cast<char *>(delta.runs.data()), runSize) && isValidDelta(delta);
+            }
+            if (!valid) {
+                std::cout << "ERROR::EDIT_JOURNAL::INVALID_DELTA: " << path << std::endl;
+                return false;
+            }
+
+            delta.position = glm::ivec3(static_cast<int32_t>(coordinates[0]), static_cast<int32_t>(coordinates[1]),
+                                        static_cast<int32_t>(coordinates[2]));
+            forEachChange(delta, [&step](int, uint8_t, uint8_t) {
+                step.voxelCount++;
+            });
+            step.bytes += getDeltaBytes(delta);
+            step.deltas.push_back(std::move(delta));
+        }
+        bytes += step.bytes;
+        steps.push_back(std::move(step));
+    }
+
+    // redo pops from the back, the oldest step has to come out first
+    clear();
+    redoSteps.assign(std::make_move_iterator(steps.rbegin()), std::make_move_iterator(steps.rend()));
+    memoryUsage = bytes;
+    return true;
+}
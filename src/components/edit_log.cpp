@@ -0,0 +1,342 @@
+#include "VoxelEngine/components/edit_log.h"
+#include "VoxelEngine/components/world.h"
+#include "VoxelEngine/utils/file_sync.h"
+#include "VoxelEngine/utils/profiler.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    void writeValue(std::vector<uint8_t> &bytes, uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8)
+            bytes.push_back(static_cast<uint8_t>(value >> shift));
+    }
+
+    void patchValue(std::vector<uint8_t> &bytes, size_t offset, uint32_t value) {
+        for (int i = 0; i < 4; i++)
+            bytes[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    bool readValue(const std::vector<uint8_t> &bytes, size_t &offset, size_t end, uint32_t &value) {
+        if (end - offset < 4)
+            return false;
+        value = bytes[offset] | (bytes[offset + 1] << 8) | (bytes[offset + 2] << 16) |
+                (static_cast<uint32_t>(bytes[offset + 3]) << 24);
+        offset += 4;
+        return true;
+    }
+
+    // CRC-32 of zlib and PNG, reflected polynomial 0xEDB88320
+    uint32_t crc32(const uint8_t *data, size_t size) {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> values{};
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; bit++)
+                    crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+                values[i] = crc;
+            }
+            return values;
+        }();
+
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    // the log needs fsync, which the standard streams do not offer
+    int openAppend(const std::string &path) {
+#ifdef _WIN32
+        return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        return open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+    }
+
+    bool writeAll(int file, const uint8_t *data, size_t size) {
+        while (size > 0) {
+#ifdef _WIN32
+            int written = _write(file, data, static_cast<unsigned int>(std::min<size_t>(size, 1 << 30)));
+#else
+            ssize_t written = write(file, data, size);
+#endif
+            if (written <= 0)
+                return false;
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    bool syncFile(int file) {
+#ifdef _WIN32
+        return _commit(file) == 0;
+#else
+        return fsync(file) == 0;
+#endif
+    }
+
+    void closeFile(int file) {
+#ifdef _WIN32
+        _close(file);
+#else
+        close(file);
+#endif
+    }
+
+    // segment number of a file named edits_<number>.wal, 0 for any other file
+    uint32_t getSegmentNumber(const std::filesystem::path &path) {
+        std::string name = path.filename().string();
+        if (name.size() <= 10 || name.compare(0, 6, "edits_") != 0 || path.extension() != ".wal")
+            return 0;
+        std::string digits = name.substr(6, name.size() - 10);
+        if (digits.empty() || digits.size() > 9 || digits.find_first_not_of("0123456789") != std::string::npos)
+            return 0;
+        return static_cast<uint32_t>(std::stoul(digits));
+    }
+}
+
+EditLog::EditLog(const std::string &directory)
+        : directory(directory) {
+    thread = std::thread([this] {
+        profiler::setThreadName("Edit log");
+        flushLoop();
+    });
+}
+
+EditLog::~EditLog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    thread.join();
+}
+
+std::string EditLog::getSegmentPath(uint32_t number) const {
+    return directory + "/edits_" + std::to_string(number) + ".wal";
+}
+
+size_t EditLog::replay(World &world) {
+    PROFILE_SCOPE("Edit log replay");
+    std::error_code error;
+    std::vector<uint32_t> found;
+    for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        uint32_t number = getSegmentNumber(it->path());
+        if (number != 0)
+            found.push_back(number);
+    }
+    std::sort(found.begin(), found.end());
+
+    size_t replayed = 0, bytesOnDisk = 0;
+    for (uint32_t number : found) {
+        std::string path = getSegmentPath(number);
+        std::ifstream file(path, std::ios::binary);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        bytesOnDisk += bytes.size();
+
+        size_t offset = 4;
+        uint32_t version;
+        if (bytes.size() < 4 || std::memcmp(bytes.data(), "VWAL", 4) != 0 ||
+            !readValue(bytes, offset, bytes.size(), version) || version != EDIT_LOG_VERSION) {
+            std::cout << "ERROR::EDIT_LOG::INVALID_FILE: " << path << std::endl;
+            continue;
+        }
+
+        while (offset < bytes.size()) {
+            uint32_t payloadSize, checksum;
+            bool valid = readValue(bytes, offset, bytes.size(), payloadSize) &&
+                         readValue(bytes, offset, bytes.size(), checksum) && payloadSize <= bytes.size() - offset &&
+                         crc32(bytes.data() + offset, payloadSize) == checksum;
+
+            ChunkDelta delta;
+            size_t end = offset + payloadSize;
+            uint32_t coordinates[3], paletteSize, runSize;
+            valid = valid && readValue(bytes, offset, end, coordinates[0]) &&
+                    readValue(bytes, offset, end, coordinates[1]) && readValue(bytes, offset, end, coordinates[2]) &&
+                    readValue(bytes, offset, end, paletteSize) && paletteSize <= end - offset;
+            if (valid) {
+                delta.palette.assign(bytes.begin() + offset, bytes.begin() + offset + paletteSize);
+                offset += paletteSize;
+                valid = readValue(bytes, offset, end, runSize) && runSize == end - offset;
+            }
+            if (valid) {
+                delta.runs.assign(bytes.begin() + offset, bytes.begin() + end);
+                valid = EditJournal::isValidDelta(delta);
+            }
+            // everything after a damaged record is dropped, it is the part of the segment a crash cut short
+            if (!valid) {
+                std::cout << "ERROR::EDIT_LOG::DAMAGED_RECORD: " << path << std::endl;
+                break;
+            }
+
+            offset = end;
+            delta.position = glm::ivec3(static_cast<int32_t>(coordinates[0]), static_cast<int32_t>(coordinates[1]),
+                                        static_cast<int32_t>(coordinates[2]));
+            world.replayDelta(delta);
+            replayed++;
+        }
+    }
+
+    // the flushing thread only reads these after the first append or compact, which come later
+    std::lock_guard<std::mutex> lock(mutex);
+    segments = found;
+    segment = found.empty() ? 1 : found.back() + 1;
+    size = bytesOnDisk;
+    return replayed;
+}
+
+void EditLog::append(const ChunkDelta &delta, bool reverse) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (batches.empty() || batches.back().segment != segment)
+        batches.push_back({segment, {}});
+    std::vector<uint8_t> &bytes = batches.back().bytes;
+
+    // payload size and checksum are patched afterwards
+    size_t start = bytes.size();
+    writeValue(bytes, 0);
+    writeValue(bytes, 0);
+    for (int axis = 0; axis < 3; axis++)
+        writeValue(bytes, static_cast<uint32_t>(delta.position[axis]));
+    writeValue(bytes, static_cast<uint32_t>(delta.palette.size()));
+    for (size_t i = 0; i < delta.palette.size(); i += 2) {
+        bytes.push_back(delta.palette[reverse ? i + 1 : i]);
+        bytes.push_back(delta.palette[reverse ? i : i + 1]);
+    }
+    writeValue(bytes, static_cast<uint32_t>(delta.runs.size()));
+    bytes.insert(bytes.end(), delta.runs.begin(), delta.runs.end());
+    patchValue(bytes, start, static_cast<uint32_t>(bytes.size() - start - 8));
+}
+
+uint32_t EditLog::startSegment() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return ++segment;
+}
+
+void EditLog::compact(uint32_t before) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        compactBefore = std::max(compactBefore, before);
+    }
+    condition.notify_one();
+}
+
+size_t EditLog::getSize() const {
+    return size.load();
+}
+
+float EditLog::getLastSyncMilliseconds() const {
+    return lastSyncMilliseconds.load();
+}
+
+// records appended before stopping are still written
+void EditLog::flushLoop() {
+    uint32_t compacted = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condition.wait_for(lock, std::chrono::duration<float>(syncInterval), [this] { return stopping; });
+        std::deque<Batch> pending;
+        pending.swap(batches);
+        uint32_t before = compactBefore;
+        bool stop = stopping;
+        lock.unlock();
+
+        if (!pending.empty())
+            flush(pending);
+        if (before > compacted) {
+            deleteSegments(before);
+            compacted = before;
+        }
+        if (stop)
+            break;
+        lock.lock();
+    }
+    if (file >= 0)
+        closeFile(file);
+}
+
+void EditLog::flush(std::deque<Batch> &pending) {
+    PROFILE_SCOPE("Edit log sync");
+    uint64_t start = profiler::now();
+    for (Batch &batch : pending) {
+        if (file < 0 || batch.segment != fileSegment) {
+            if (file >= 0) {
+                syncFile(file);
+                closeFile(file);
+            }
+            std::error_code error;
+            std::filesystem::create_directories(directory, error);
+            file = openAppend(getSegmentPath(batch.segment));
+            fileSegment = batch.segment;
+            if (file < 0) {
+                std::cout << "ERROR::EDIT_LOG::FILE_NOT_WRITTEN: " << getSegmentPath(batch.segment) << std::endl;
+                continue;
+            }
+            std::vector<uint8_t> header = {'V', 'W', 'A', 'L'};
+            writeValue(header, EDIT_LOG_VERSION);
+            if (!writeAll(file, header.data(), header.size())) {
+                // a segment without its header is not replayed, the next batch starts it again
+                std::cout << "ERROR::EDIT_LOG::FILE_NOT_WRITTEN: " << getSegmentPath(batch.segment) << std::endl;
+                closeFile(file);
+                file = -1;
+                std::filesystem::remove(getSegmentPath(batch.segment), error);
+                continue;
+            }
+            // the new file itself only survives a power loss once its directory is synced
+            if (!flushDirectoryToDisk(directory))
+                std::cout << "ERROR::EDIT_LOG::DIRECTORY_NOT_SYNCED: " << directory << std::endl;
+            segments.push_back(batch.segment);
+            size += header.size();
+        }
+        if (file < 0)
+            continue;
+
+        for (size_t offset = 0; offset < batch.bytes.size();) {
+            uint32_t payloadSize, checksum;
+            size_t checksumOffset = offset + 4;
+            readValue(batch.bytes, offset, batch.bytes.size(), payloadSize);
+            checksum = crc32(batch.bytes.data() + offset + 4, payloadSize);
+            patchValue(batch.bytes, checksumOffset, checksum);
+            offset += 4 + payloadSize;
+        }
+        if (!writeAll(file, batch.bytes.data(), batch.bytes.size()))
+            std::cout << "ERROR::EDIT_LOG::FILE_NOT_WRITTEN: " << getSegmentPath(batch.segment) << std::endl;
+        size += batch.bytes.size();
+    }
+    if (file >= 0)
+        syncFile(file);
+    lastSyncMilliseconds = static_cast<float>(profiler::now() - start) / 1000000.0f;
+}
+
+void EditLog::deleteSegments(uint32_t before) {
+    auto end = std::partition(segments.begin(), segments.end(), [before](uint32_t number) {
+        return number >= before;
+    });
+    for (auto it = end; it != segments.end(); ++it) {
+        if (file >= 0 && fileSegment == *it) {
+            closeFile(file);
+            file = -1;
+        }
+        std::string path = getSegmentPath(*it);
+        std::error_code error;
+        uintmax_t bytes = std::filesystem::file_size(path, error);
+        if (std::filesystem::remove(path, error) && bytes != static_cast<uintmax_t>(-1))
+            size -= static_cast<size_t>(bytes);
+    }
+    segments.erase(end, segments.end());
+}
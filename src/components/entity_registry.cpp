@@ -0,0 +1,152 @@
+#include "VoxelEngine/components/entity_registry.h"
+#include "VoxelEngine/utils/memory_tracker.h"
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+
+namespace {
+    std::mutex typeMutex;
+    size_t typeSizes[MAX_COMPONENT_TYPES];
+    int typeCount = 0;
+}
+
+int ComponentTypes::registerType(size_t size) {
+    std::lock_guard<std::mutex> lock(typeMutex);
+    if (typeCount == MAX_COMPONENT_TYPES) {
+        std::cout << "ERROR::ENTITY_REGISTRY::TOO_MANY_COMPONENT_TYPES: " << MAX_COMPONENT_TYPES << std::endl;
+        std::abort();
+    }
+    typeSizes[typeCount] = size;
+    return typeCount++;
+}
+
+// sizes never change once registered, and an id is only known after its registration
+size_t ComponentTypes::getSize(int id) {
+    return typeSizes[id];
+}
+
+uint32_t EntityRegistry::getArchetype(ComponentMask mask) {
+    auto found = archetypeIndices.find(mask);
+    if (found != archetypeIndices.end())
+        return found->second;
+
+    MEMORY_SCOPE(MEMORY_ENTITIES);
+    archetypes.emplace_back();
+    archetypes.back().mask = mask;
+    uint32_t index = static_cast<uint32_t>(archetypes.size() - 1);
+    archetypeIndices[mask] = index;
+    return index;
+}
+
+uint32_t EntityRegistry::addRow(Archetype &archetype, Entity entity) {
+    MEMORY_SCOPE(MEMORY_ENTITIES);
+    for (int id = 0; id < MAX_COMPONENT_TYPES; id++) {
+        if (archetype.mask & (ComponentMask(1) << id))
+            archetype.columns[id].resize(archetype.columns[id].size() + ComponentTypes::getSize(id), 0);
+    }
+    archetype.entities.push_back(entity);
+    return static_cast<uint32_t>(archetype.entities.size() - 1);
+}
+
+void EntityRegistry::removeRow(Archetype &archetype, uint32_t row) {
+    uint32_t last = static_cast<uint32_t>(archetype.entities.size() - 1);
+    for (int id = 0; id < MAX_COMPONENT_TYPES; id++) {
+        if ((archetype.mask & (ComponentMask(1) << id)) == 0)
+            continue;
+        std::vector<uint8_t> &column = archetype.columns[id];
+        size_t size = ComponentTypes::getSize(id);
+        if (row != last)
+            std::memcpy(column.data() + row * size, column.data() + last * size, size);
+        column.resize(column.size() - size);
+    }
+    if (row != last) {
+        Entity moved = archetype.entities[last];
+        archetype.entities[row] = moved;
+        records[moved.index].row = row;
+    }
+    archetype.entities.pop_back();
+}
+
+Entity EntityRegistry::createEntity(ComponentMask mask) {
+    Entity entity;
+    if (!freeIndices.empty()) {
+        entity.index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        MEMORY_SCOPE(MEMORY_ENTITIES);
+        entity.index = static_cast<uint32_t>(records.size());
+        records.emplace_back();
+    }
+    EntityRecord &record = records[entity.index];
+    entity.generation = record.generation;
+
+    record.archetype = getArchetype(mask);
+    record.row = addRow(archetypes[record.archetype], entity);
+    record.alive = true;
+    entityCount++;
+    return entity;
+}
+
+void EntityRegistry::moveEntity(Entity entity, ComponentMask mask) {
+    EntityRecord &record = records[entity.index];
+    if (archetypes[record.archetype].mask == mask)
+        return;
+
+    // may grow archetypes, references into it are taken after
+    uint32_t target = getArchetype(mask);
+    Archetype &from = archetypes[record.archetype];
+    Archetype &to = archetypes[target];
+    uint32_t row = addRow(to, entity);
+
+    // components of both sets keep their value, added ones start zeroed
+    ComponentMask shared = from.mask & to.mask;
+    for (int id = 0; id < MAX_COMPONENT_TYPES; id++) {
+        if ((shared & (ComponentMask(1) << id)) == 0)
+            continue;
+        size_t size = ComponentTypes::getSize(id);
+        std::memcpy(to.columns[id].data() + row * size, from.columns[id].data() + record.row * size, size);
+    }
+    removeRow(from, record.row);
+
+    record.archetype = target;
+    record.row = row;
+}
+
+void EntityRegistry::destroy(Entity entity) {
+    if (!isAlive(entity))
+        return;
+    EntityRecord &record = records[entity.index];
+    removeRow(archetypes[record.archetype], record.row);
+    record.alive = false;
+    record.generation++;
+    freeIndices.push_back(entity.index);
+    entityCount--;
+}
+
+void EntityRegistry::clear() {
+    for (Archetype &archetype : archetypes) {
+        for (Entity entity : archetype.entities) {
+            EntityRecord &record = records[entity.index];
+            record.alive = false;
+            record.generation++;
+            freeIndices.push_back(entity.index);
+        }
+        for (std::vector<uint8_t> &column : archetype.columns)
+            column.clear();
+        archetype.entities.clear();
+    }
+    entityCount = 0;
+}
+
+bool EntityRegistry::isAlive(Entity entity) const {
+    return entity.index < records.size() && records[entity.index].alive &&
+           records[entity.index].generation == entity.generation;
+}
+
+size_t EntityRegistry::getEntityCount() const {
+    return entityCount;
+}
+
+size_t EntityRegistry::getArchetypeCount() const {
+    return archetypes.size();
+}
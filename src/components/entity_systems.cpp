@@ -0,0 +1,65 @@
+#include "VoxelEngine/components/entity_systems.h"
+#include "VoxelEngine/utils/profiler.h"
+#include <atomic>
+#include <random>
+
+void updateMotion(EntityRegistry &registry, thread_pool *pool, float deltaTime, const glm::vec3 &min,
+                  const glm::vec3 &max) {
+    PROFILE_SCOPE("Entity motion");
+    auto move = [deltaTime, min, max](size_t count, Position *positions, Velocity *velocities) {
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 position = positions[i].value + velocities[i].value * deltaTime;
+            glm::vec3 velocity = velocities[i].value;
+            for (int axis = 0; axis < 3; axis++) {
+                if (position[axis] < min[axis]) {
+                    position[axis] = 2.0f * min[axis] - position[axis];
+                    velocity[axis] = -velocity[axis];
+                } else if (position[axis] > max[axis]) {
+                    position[axis] = 2.0f * max[axis] - position[axis];
+                    velocity[axis] = -velocity[axis];
+                }
+            }
+            positions[i].value = position;
+            velocities[i].value = velocity;
+        }
+    };
+    if (pool != nullptr)
+        registry.forEachParallel<Position, Velocity>(*pool, ENTITY_BATCH_SIZE, move);
+    else
+        registry.forEach<Position, Velocity>(move);
+}
+
+size_t appendInstanceMatrices(EntityRegistry &registry, thread_pool *pool, std::vector<glm::mat4> &matrices) {
+    PROFILE_SCOPE("Entity matrices");
+    size_t first = matrices.size();
+    size_t count = registry.count<Position, Renderable>();
+    matrices.resize(first + count);
+
+    // every batch claims its range of the output, batches finish in any order
+    std::atomic<size_t> cursor{first};
+    glm::mat4 *output = matrices.data();
+    auto write = [output, &cursor](size_t count, Position *positions, Renderable *renderables) {
+        glm::mat4 *matrix = output + cursor.fetch_add(count);
+        for (size_t i = 0; i < count; i++, matrix++) {
+            float scale = renderables[i].scale;
+            *matrix = glm::mat4(scale);
+            (*matrix)[3] = glm::vec4(positions[i].value, 1.0f);
+        }
+    };
+    if (pool != nullptr)
+        registry.forEachParallel<Position, Renderable>(*pool, ENTITY_BATCH_SIZE, write);
+    else
+        registry.forEach<Position, Renderable>(write);
+    return count;
+}
+
+void spawnMovingEntities(EntityRegistry &registry, size_t count, const glm::vec3 &min, const glm::vec3 &max,
+                         float speed, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f), velocity(-speed, speed), scale(0.2f, 0.6f);
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 position = min + (max - min) * glm::vec3(unit(random), unit(random), unit(random));
+        registry.create(Position{position}, Velocity{glm::vec3(velocity(random), velocity(random), velocity(random))},
+                        Renderable{scale(random)});
+    }
+}
@@ -0,0 +1,29 @@
+#include "VoxelEngine/components/terrain_generator.h"
+#include "VoxelEngine/components/block_registry.h"
+#include "VoxelEngine/utils/profiler.h"
+#include <glm/gtc/noise.hpp>
+
+void TerrainGenerator::fill(Chunk &chunk, const glm::ivec3 &min, const glm::ivec3 &max) const {
+    PROFILE_SCOPE("Terrain generate");
+    const float scale = static_cast<float>(chunk.scale);
+    const glm::vec3 origin = chunk.getMin();
+    for (int z = min.z; z < max.z; z++) {
+        for (int x = min.x; x < max.x; x++) {
+            glm::vec2 column(origin.x + x * scale, origin.z + z * scale);
+            float height = -8.0f + 10.0f * glm::simplex(column / 96.0f) + 3.0f * glm::simplex(column / 24.0f);
+
+            for (int y = min.y; y < max.y; y++) {
+                float worldY = origin.y + y * scale;
+                if (worldY > height)
+                    continue;
+
+                float depth = height - worldY;
+                if (depth > 4.0f && glm::simplex(glm::vec3(column.x, worldY * 1.5f, column.y) / 32.0f) > 0.45f)
+                    continue;
+
+                uint8_t id = depth < 1.0f ? BLOCK_GRASS : (depth < 4.0f ? BLOCK_DIRT : BLOCK_STONE);
+                chunk.setVoxel(x, y, z, id);
+            }
+        }
+    }
+}
@@ -0,0 +1,158 @@
+#include "VoxelEngine/components/voxel_physics.h"
+#include "VoxelEngine/utils/profiler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // keeps boxes resting exactly on a voxel face from overlapping the voxel behind it
+    const float SWEEP_EPSILON = 1e-4f;
+
+    int floorDivide(int value, int divisor) {
+        return (value >= 0 ? value : value - (divisor - 1)) / divisor;
+    }
+
+    int toVoxel(float value) {
+        return static_cast<int>(std::floor(value));
+    }
+}
+
+size_t PhysicsBodies::add(const glm::vec3 &position, float width, float boxHeight, float step) {
+    positionX.push_back(position.x);
+    positionY.push_back(position.y);
+    positionZ.push_back(position.z);
+    velocityX.push_back(0.0f);
+    velocityY.push_back(0.0f);
+    velocityZ.push_back(0.0f);
+    halfWidth.push_back(width);
+    height.push_back(boxHeight);
+    stepHeight.push_back(step);
+    gravityScale.push_back(1.0f);
+    onGround.push_back(0);
+    return positionX.size() - 1;
+}
+
+size_t PhysicsBodies::size() const {
+    return positionX.size();
+}
+
+void PhysicsBodies::clear() {
+    for (std::vector<float> *values : {&positionX, &positionY, &positionZ, &velocityX, &velocityY, &velocityZ,
+                                       &halfWidth, &height, &stepHeight, &gravityScale})
+        values->clear();
+    onGround.clear();
+}
+
+VoxelPhysics::VoxelPhysics(const World &world)
+        : world(world) {
+}
+
+bool VoxelPhysics::isSolid(VoxelCache &cache, int x, int y, int z) const {
+    glm::ivec3 chunkPosition(floorDivide(x, CHUNK_SIZE), floorDivide(y, CHUNK_SIZE), floorDivide(z, CHUNK_SIZE));
+    if (chunkPosition != cache.position) {
+        cache.position = chunkPosition;
+        cache.chunk = world.getChunk(chunkPosition);
+    }
+    if (cache.chunk == nullptr)
+        return false;
+    glm::ivec3 local = glm::ivec3(x, y, z) - chunkPosition * CHUNK_SIZE;
+    return cache.chunk->getVoxel(local.x, local.y, local.z) != BLOCK_AIR;
+}
+
+// the voxels of one layer along axis covered by the other two axes of the box
+bool VoxelPhysics::isLayerSolid(VoxelCache &cache, const glm::vec3 &min, const glm::vec3 &max, int axis,
+                                int layer) const {
+    int a = (axis + 1) % 3, b = (axis + 2) % 3;
+    int fromA = toVoxel(min[a] + SWEEP_EPSILON), toA = toVoxel(max[a] - SWEEP_EPSILON);
+    int fromB = toVoxel(min[b] + SWEEP_EPSILON), toB = toVoxel(max[b] - SWEEP_EPSILON);
+    glm::ivec3 voxel;
+    voxel[axis] = layer;
+    for (int i = fromA; i <= toA; i++) {
+        for (int j = fromB; j <= toB; j++) {
+            voxel[a] = i;
+            voxel[b] = j;
+            if (isSolid(cache, voxel.x, voxel.y, voxel.z))
+                return true;
+        }
+    }
+    return false;
+}
+
+float VoxelPhysics::sweep(VoxelCache &cache, glm::vec3 &min, glm::vec3 &max, int axis, float distance) const {
+    if (distance > 0.0f) {
+        // layers entered by the leading face, nearest first
+        int first = toVoxel(max[axis] - SWEEP_EPSILON) + 1;
+        int last = toVoxel(max[axis] + distance - SWEEP_EPSILON);
+        for (int layer = first; layer <= last; layer++) {
+            if (isLayerSolid(cache, min, max, axis, layer)) {
+                distance = std::max(static_cast<float>(layer) - max[axis], 0.0f);
+                break;
+            }
+        }
+    } else if (distance < 0.0f) {
+        int first = toVoxel(min[axis] + SWEEP_EPSILON) - 1;
+        int last = toVoxel(min[axis] + distance + SWEEP_EPSILON);
+        for (int layer = first; layer >= last; layer--) {
+            if (isLayerSolid(cache, min, max, axis, layer)) {
+                distance = std::min(static_cast<float>(layer + 1) - min[axis], 0.0f);
+                break;
+            }
+        }
+    }
+    min[axis] += distance;
+    max[axis] += distance;
+    return distance;
+}
+
+void VoxelPhysics::step(PhysicsBodies &bodies, float deltaTime, size_t first, size_t last) const {
+    PROFILE_SCOPE("Physics step");
+    // gravity on every body at once, a plain loop over the arrays
+    float *velocityY = bodies.velocityY.data();
+    const float *gravityScale = bodies.gravityScale.data();
+    for (size_t i = first; i < last; i++)
+        velocityY[i] = std::max(velocityY[i] - gravityScale[i] * gravity * deltaTime, -terminalVelocity);
+
+    VoxelCache cache;
+    for (size_t i = first; i < last; i++) {
+        float halfWidth = bodies.halfWidth[i];
+        glm::vec3 min(bodies.positionX[i] - halfWidth, bodies.positionY[i], bodies.positionZ[i] - halfWidth);
+        glm::vec3 max(bodies.positionX[i] + halfWidth, bodies.positionY[i] + bodies.height[i],
+                      bodies.positionZ[i] + halfWidth);
+        glm::vec3 velocity(bodies.velocityX[i], bodies.velocityY[i], bodies.velocityZ[i]);
+        glm::vec3 move = velocity * deltaTime;
+
+        float moved = sweep(cache, min, max, 1, move.y);
+        bool grounded = move.y < 0.0f && moved > move.y;
+        if (moved != move.y)
+            velocity.y = 0.0f;
+
+        for (int axis : {0, 2}) {
+            moved = sweep(cache, min, max, axis, move[axis]);
+            if (moved == move[axis])
+                continue;
+
+            float step = bodies.stepHeight[i];
+            if ((grounded || bodies.onGround[i]) && step > 0.0f) {
+                // climb, move the rest of the way, then settle back down onto the ledge
+                glm::vec3 stepMin = min, stepMax = max;
+                float climbed = sweep(cache, stepMin, stepMax, 1, step);
+                float stepMoved = sweep(cache, stepMin, stepMax, axis, move[axis] - moved);
+                if (std::abs(stepMoved) > SWEEP_EPSILON) {
+                    sweep(cache, stepMin, stepMax, 1, -climbed);
+                    min = stepMin;
+                    max = stepMax;
+                    moved += stepMoved;
+                }
+            }
+            if (std::abs(moved - move[axis]) > SWEEP_EPSILON)
+                velocity[axis] = 0.0f;
+        }
+
+        bodies.positionX[i] = (min.x + max.x) * 0.5f;
+        bodies.positionY[i] = min.y;
+        bodies.positionZ[i] = (min.z + max.z) * 0.5f;
+        bodies.velocityX[i] = velocity.x;
+        bodies.velocityY[i] = velocity.y;
+        bodies.velocityZ[i] = velocity.z;
+        bodies.onGround[i] = grounded;
+    }
+}
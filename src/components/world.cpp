@@ -0,0 +1,556 @@
+#include "VoxelEngine/components/world.h"
+#include "VoxelEngine/components/edit_log.h"
+#include "VoxelEngine/utils/frame_arena.h"
+#include "VoxelEngine/utils/profiler.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    // levels of detail of the neighbour behind a face that read voxels of the box [min, max] of the chunk. Level n
+    // samples the 2^n layers along the face. The skirts of the chunk below look CHUNK_SKIRT_DEPTH layers up at
+    // every level, for the surface above the faces they stand in for
+    uint8_t getNeighbourLods(const glm::ivec3 &min, const glm::ivec3 &max, int face) {
+        int axis = face / 2;
+        int depth = (face & 1) ? CHUNK_SIZE - 1 - max[axis] : min[axis];
+        if (face == FACE_NEG_Y && depth < CHUNK_SKIRT_DEPTH)
+            return CHUNK_ALL_LODS;
+        uint8_t lods = 0;
+        for (int lod = 0; lod < CHUNK_LOD_COUNT; lod++) {
+            if (depth < (1 << lod))
+                lods |= 1 << lod;
+        }
+        return lods;
+    }
+
+    // rounds towards negative infinity, voxel -1 is in chunk -1
+    glm::ivec3 voxelToChunk(const glm::ivec3 &position) {
+        glm::ivec3 chunk;
+        for (int axis = 0; axis < 3; axis++) {
+            int p = position[axis];
+            chunk[axis] = (p >= 0 ? p : p - (CHUNK_SIZE - 1)) / CHUNK_SIZE;
+        }
+        return chunk;
+    }
+}
+
+World::World(thread_pool &pool, const BlockRegistry &registry, int radius, int minChunkY, int maxChunkY)
+        : radius(radius), minChunkY(minChunkY), maxChunkY(maxChunkY), pool(pool), registry(registry) {
+}
+
+World::~World() {
+    while (jobsInFlight.load() > 0)
+        std::this_thread::yield();
+}
+
+void World::generate() {
+    PROFILE_SCOPE("World generate");
+    for (int x = -radius; x < radius; x++) {
+        for (int y = minChunkY; y < maxChunkY; y++) {
+            for (int z = -radius; z < radius; z++) {
+                glm::ivec3 position(x, y, z);
+                std::unique_ptr<Chunk> chunk(new Chunk(position));
+                generator.fill(*chunk);
+                chunks[position] = std::move(chunk);
+            }
+        }
+    }
+
+    // meshing needs the neighbours, so it runs once every chunk is filled
+    for (auto &entry : chunks) {
+        meshChunk(*entry.second);
+        for (ChunkMesh &mesh : entry.second->meshes)
+            mesh.upload();
+    }
+}
+
+Chunk *World::getChunk(const glm::ivec3 &position) const {
+    auto it = chunks.find(position);
+    return it != chunks.end() ? it->second.get() : nullptr;
+}
+
+uint8_t World::getVoxel(const glm::ivec3 &position) const {
+    glm::ivec3 chunkPosition = voxelToChunk(position);
+    const Chunk *chunk = getChunk(chunkPosition);
+    if (chunk == nullptr)
+        return BLOCK_AIR;
+    glm::ivec3 local = position - chunkPosition * CHUNK_SIZE;
+    return chunk->getVoxel(local.x, local.y, local.z);
+}
+
+bool World::setVoxel(const glm::ivec3 &position, uint8_t id) {
+    glm::ivec3 chunkPosition = voxelToChunk(position);
+    Chunk *chunk = getChunk(chunkPosition);
+    if (chunk == nullptr)
+        return false;
+    glm::ivec3 local = position - chunkPosition * CHUNK_SIZE;
+    uint8_t previous = chunk->getVoxel(local.x, local.y, local.z);
+    if (previous == id)
+        return false;
+    chunk->setVoxel(local.x, local.y, local.z, id);
+
+    journal.beginStep();
+    journal.beginChunk(chunkPosition);
+    journal.recordChange(Chunk::index(local.x, local.y, local.z), previous, id);
+    logDelta(journal.endChunk(), false);
+    journal.endStep();
+
+    markEdited(chunkPosition, local, local, profiler::now());
+    return true;
+}
+
+void World::markDirty(const glm::ivec3 &position, uint64_t time, uint8_t lods) {
+    if (getChunk(position) == nullptr)
+        return;
+    // an already dirty chunk keeps the time of its first edit
+    dirtyChunks.emplace(position, DirtyChunk{time, 0}).first->second.lods |= lods;
+}
+
+void World::markEdited(const glm::ivec3 &position, const glm::ivec3 &min, const glm::ivec3 &max, uint64_t time) {
+    unsavedChunks.insert(position);
+    markDirty(position, time, CHUNK_ALL_LODS);
+    for (int face = 0; face < 6; face++) {
+        uint8_t lods = getNeighbourLods(min, max, face);
+        if (lods != 0)
+            markDirty(position + FACE_OFFSETS[face], time, lods);
+    }
+}
+
+template<typename Edit>
+size_t World::editBox(const glm::ivec3 &min, const glm::ivec3 &max, Edit edit) {
+    if (glm::any(glm::greaterThanEqual(min, max)))
+        return 0;
+
+    uint64_t time = profiler::now();
+    glm::ivec3 firstChunk = voxelToChunk(min), lastChunk = voxelToChunk(max - 1);
+    size_t changed = 0;
+    journal.beginStep();
+    for (int cz = firstChunk.z; cz <= lastChunk.z; cz++) {
+        for (int cy = firstChunk.y; cy <= lastChunk.y; cy++) {
+            for (int cx = firstChunk.x; cx <= lastChunk.x; cx++) {
+                glm::ivec3 chunkPosition(cx, cy, cz);
+                Chunk *chunk = getChunk(chunkPosition);
+                if (chunk == nullptr)
+                    continue;
+
+                glm::ivec3 origin = chunkPosition * CHUNK_SIZE;
+                glm::ivec3 from = glm::max(min - origin, glm::ivec3(0));
+                glm::ivec3 to = glm::min(max - origin, glm::ivec3(CHUNK_SIZE));
+                size_t chunkChanged = 0;
+                // bounds of the changed voxels, the neighbours only remesh the levels reading them
+                glm::ivec3 changedMin(CHUNK_SIZE), changedMax(-1);
+                // a shared array is only copied once the edit really changes the chunk
+                const uint8_t *voxels = chunk->voxels.data();
+                uint8_t *writable = nullptr;
+                // rows are visited by increasing voxel index, the order the journal records them in
+                journal.beginChunk(chunkPosition);
+                for (int z = from.z; z < to.z; z++) {
+                    for (int y = from.y; y < to.y; y++) {
+                        int row = Chunk::index(0, y, z);
+                        for (int x = from.x; x < to.x; x++) {
+                            uint8_t previous = voxels[row + x];
+                            uint8_t voxel = previous;
+                            edit(origin + glm::ivec3(x, y, z), voxel);
+                            if (voxel == previous)
+                                continue;
+                            if (writable == nullptr)
+                                voxels = writable = chunk->voxels.edit();
+                            writable[row + x] = voxel;
+                            chunkChanged++;
+                            changedMin = glm::min(changedMin, glm::ivec3(x, y, z));
+                            changedMax = glm::max(changedMax, glm::ivec3(x, y, z));
+                            journal.recordChange(row + x, previous, voxel);
+                        }
+                    }
+                }
+                logDelta(journal.endChunk(), false);
+
+                if (chunkChanged == 0)
+                    continue;
+                changed += chunkChanged;
+                markEdited(chunkPosition, changedMin, changedMax, time);
+            }
+        }
+    }
+    journal.endStep();
+    return changed;
+}
+
+bool World::undo() {
+    const EditStep *step = journal.undo();
+    if (step == nullptr)
+        return false;
+    for (auto it = step->deltas.rbegin(); it != step->deltas.rend(); ++it) {
+        applyDelta(*it, true);
+        logDelta(&*it, true);
+    }
+    return true;
+}
+
+bool World::redo() {
+    const EditStep *step = journal.redo();
+    if (step == nullptr)
+        return false;
+    for (const ChunkDelta &delta : step->deltas) {
+        applyDelta(delta, false);
+        logDelta(&delta, false);
+    }
+    return true;
+}
+
+void World::replayDelta(const ChunkDelta &delta) {
+    applyDelta(delta, false);
+}
+
+void World::logDelta(const ChunkDelta *delta, bool reverse) {
+    if (delta != nullptr && editLog != nullptr)
+        editLog->append(*delta, reverse);
+}
+
+// writes the old or new blocks of a delta without recording it again
+void World::applyDelta(const ChunkDelta &delta, bool reverse) {
+    Chunk *chunk = getChunk(delta.position);
+    if (chunk == nullptr)
+        return;
+
+    // bounds of the changed voxels, as for the edit the delta undoes or redoes
+    glm::ivec3 changedMin(CHUNK_SIZE), changedMax(-1);
+    uint8_t *voxels = chunk->voxels.edit();
+    EditJournal::forEachChange(delta, [voxels, reverse, &changedMin, &changedMax](int index, uint8_t previous,
+                                                                                  uint8_t id) {
+        voxels[index] = reverse ? previous : id;
+        glm::ivec3 local(index % CHUNK_SIZE, (index / CHUNK_SIZE) % CHUNK_SIZE, index / (CHUNK_SIZE * CHUNK_SIZE));
+        changedMin = glm::min(changedMin, local);
+        changedMax = glm::max(changedMax, local);
+    });
+    markEdited(delta.position, changedMin, changedMax, profiler::now());
+}
+
+size_t World::fillBox(const glm::ivec3 &min, const glm::ivec3 &max, uint8_t id) {
+    PROFILE_SCOPE("Fill box");
+    return editBox(min, max, [id](const glm::ivec3 &, uint8_t &voxel) {
+        voxel = id;
+    });
+}
+
+size_t World::fillSphere(const glm::vec3 &center, float radius, uint8_t id) {
+    PROFILE_SCOPE("Fill sphere");
+    glm::ivec3 min(glm::floor(center - radius));
+    glm::ivec3 max = glm::ivec3(glm::ceil(center + radius)) + 1;
+    float radiusSquared = radius * radius;
+    return editBox(min, max, [&center, radiusSquared, id](const glm::ivec3 &position, uint8_t &voxel) {
+        glm::vec3 offset = glm::vec3(position) + 0.5f - center;
+        if (glm::dot(offset, offset) <= radiusSquared)
+            voxel = id;
+    });
+}
+
+void World::copyRegion(const glm::ivec3 &min, const glm::ivec3 &max, VoxelRegion &region) const {
+    PROFILE_SCOPE("Copy region");
+    region.size = glm::max(max - min, glm::ivec3(0));
+    region.voxels.assign(static_cast<size_t>(region.size.x) * region.size.y * region.size.z, BLOCK_AIR);
+    if (region.voxels.empty())
+        return;
+
+    glm::ivec3 firstChunk = voxelToChunk(min), lastChunk = voxelToChunk(max - 1);
+    for (int cz = firstChunk.z; cz <= lastChunk.z; cz++) {
+        for (int cy = firstChunk.y; cy <= lastChunk.y; cy++) {
+            for (int cx = firstChunk.x; cx <= lastChunk.x; cx++) {
+                const Chunk *chunk = getChunk(glm::ivec3(cx, cy, cz));
+                if (chunk == nullptr)
+                    continue;
+
+                glm::ivec3 origin = chunk->position * CHUNK_SIZE;
+                glm::ivec3 from = glm::max(min - origin, glm::ivec3(0));
+                glm::ivec3 to = glm::min(max - origin, glm::ivec3(CHUNK_SIZE));
+                // rows are contiguous on both sides
+                for (int z = from.z; z < to.z; z++) {
+                    for (int y = from.y; y < to.y; y++) {
+                        glm::ivec3 target = origin + glm::ivec3(from.x, y, z) - min;
+                        std::copy_n(chunk->voxels.data() + Chunk::index(from.x, y, z), to.x - from.x,
+                                    &region.voxels[target.x + region.size.x * (target.y + region.size.y * target.z)]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+size_t World::pasteRegion(const VoxelRegion &region, const glm::ivec3 &origin, bool skipAir) {
+    PROFILE_SCOPE("Paste region");
+    return editBox(origin, origin + region.size, [&region, &origin, skipAir](const glm::ivec3 &position,
+                                                                             uint8_t &voxel) {
+        glm::ivec3 local = position - origin;
+        uint8_t id = region.get(local.x, local.y, local.z);
+        if (!skipAir || id != BLOCK_AIR)
+            voxel = id;
+    });
+}
+
+// steps through the voxels in the order the ray enters them, see "A Fast Voxel Traversal Algorithm for Ray Tracing"
+bool World::raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, VoxelHit &hit) const {
+    const float infinity = std::numeric_limits<float>::infinity();
+    glm::ivec3 voxel(glm::floor(origin));
+    glm::ivec3 step(0);
+    // distance along the ray to the next voxel border of each axis, and between two borders
+    glm::vec3 next(infinity), delta(infinity);
+    for (int axis = 0; axis < 3; axis++) {
+        if (direction[axis] > 0.0f) {
+            step[axis] = 1;
+            delta[axis] = 1.0f / direction[axis];
+            next[axis] = (static_cast<float>(voxel[axis] + 1) - origin[axis]) * delta[axis];
+        } else if (direction[axis] < 0.0f) {
+            step[axis] = -1;
+            delta[axis] = -1.0f / direction[axis];
+            next[axis] = (origin[axis] - static_cast<float>(voxel[axis])) * delta[axis];
+        }
+    }
+
+    glm::ivec3 previous = voxel;
+    float distance = 0.0f;
+    while (distance <= maxDistance) {
+        if (getVoxel(voxel) != BLOCK_AIR) {
+            hit = {voxel, previous, distance};
+            return true;
+        }
+        previous = voxel;
+        int axis = next.x < next.y ? (next.x < next.z ? 0 : 2) : (next.y < next.z ? 1 : 2);
+        distance = next[axis];
+        voxel[axis] += step[axis];
+        next[axis] += delta[axis];
+    }
+    return false;
+}
+
+WorldSnapshot World::createSnapshot() {
+    PROFILE_SCOPE("World snapshot");
+    WorldSnapshot snapshot;
+    snapshot.chunks.reserve(chunks.size());
+    for (const auto &entry : chunks)
+        snapshot.chunks.push_back({entry.first, entry.second->voxels.share()});
+    snapshot.edited.assign(unsavedChunks.begin(), unsavedChunks.end());
+    unsavedChunks.clear();
+    return snapshot;
+}
+
+void World::markUnsaved(const std::vector<glm::ivec3> &positions) {
+    unsavedChunks.insert(positions.begin(), positions.end());
+}
+
+size_t World::getUnsavedCount() const {
+    return unsavedChunks.size();
+}
+
+bool World::loadChunk(const glm::ivec3 &position, const uint8_t *voxels) {
+    Chunk *chunk = getChunk(position);
+    if (chunk == nullptr)
+        return false;
+    std::copy_n(voxels, CHUNK_VOLUME, chunk->voxels.edit());
+
+    // every border may have changed
+    uint64_t time = profiler::now();
+    markDirty(position, time, CHUNK_ALL_LODS);
+    for (int face = 0; face < 6; face++)
+        markDirty(position + FACE_OFFSETS[face], time, CHUNK_ALL_LODS);
+    return true;
+}
+
+void World::update() {
+    PROFILE_SCOPE("World update");
+    editLatencies.clear();
+
+    arena_vector<std::shared_ptr<RemeshJob>> finished(frame_arena::allocator<std::shared_ptr<RemeshJob>>());
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        finished.assign(completed.begin(), completed.end());
+        completed.clear();
+    }
+    for (const std::shared_ptr<RemeshJob> &job : finished)
+        applyRemesh(*job);
+
+    // chunks still being remeshed wait for their job, the edits made since then need another one
+    for (auto it = dirtyChunks.begin(); it != dirtyChunks.end();) {
+        if (remeshing.count(it->first) != 0) {
+            ++it;
+            continue;
+        }
+        queueRemesh(it->first, it->second);
+        it = dirtyChunks.erase(it);
+    }
+}
+
+void World::queueRemesh(const glm::ivec3 &position, const DirtyChunk &dirty) {
+    std::shared_ptr<RemeshJob> job = std::make_shared<RemeshJob>();
+    job->position = position;
+    job->editTime = dirty.editTime;
+    job->lods = dirty.lods;
+    job->chunk.reset(new Chunk(position));
+    job->chunk->voxels = getChunk(position)->voxels;
+    for (int face = 0; face < 6; face++) {
+        const Chunk *neighbour = getChunk(position + FACE_OFFSETS[face]);
+        if (neighbour == nullptr)
+            continue;
+        job->neighbours[face].reset(new Chunk(neighbour->position));
+        job->neighbours[face]->voxels = neighbour->voxels;
+    }
+
+    remeshing.insert(position);
+    jobsInFlight++;
+    // ahead of the streaming jobs, someone is waiting to see the edit
+    pool.enqueue([this, job]() mutable {
+        const Chunk *neighbours[6];
+        for (int face = 0; face < 6; face++)
+            neighbours[face] = job->neighbours[face].get();
+        job->chunk->buildMesh(neighbours, registry, job->lods);
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completed.push_back(job);
+        }
+        job.reset();
+        jobsInFlight--;
+    }, -1);
+}
+
+void World::applyRemesh(RemeshJob &job) {
+    remeshing.erase(job.position);
+    Chunk *chunk = getChunk(job.position);
+    if (chunk == nullptr)
+        return;
+
+    for (int lod = 0; lod < CHUNK_LOD_COUNT; lod++) {
+        if ((job.lods & (1 << lod)) == 0)
+            continue;
+        ChunkMesh &target = chunk->meshes[lod];
+        ChunkMesh &source = job.chunk->meshes[lod];
+        target.vertices.swap(source.vertices);
+        target.indices.swap(source.indices);
+        target.surfaceCount = source.surfaceCount;
+        std::copy(source.skirtOffset, source.skirtOffset + 6, target.skirtOffset);
+        std::copy(source.skirtCount, source.skirtCount + 6, target.skirtCount);
+        target.upload();
+    }
+    chunk->connectivity = job.chunk->connectivity;
+    editLatencies.push_back(static_cast<float>(profiler::now() - job.editTime) / 1000000.0f);
+}
+
+const std::vector<float> &World::getEditLatencies() const {
+    return editLatencies;
+}
+
+int World::getRemeshPendingCount() const {
+    return static_cast<int>(dirtyChunks.size() + remeshing.size());
+}
+
+glm::ivec3 World::worldToChunk(const glm::vec3 &position) {
+    return glm::ivec3(glm::floor(position / static_cast<float>(CHUNK_SIZE)));
+}
+
+glm::vec3 World::getMin() const {
+    return glm::vec3(-radius, minChunkY, -radius) * static_cast<float>(CHUNK_SIZE);
+}
+
+glm::vec3 World::getMax() const {
+    return glm::vec3(radius, maxChunkY, radius) * static_cast<float>(CHUNK_SIZE);
+}
+
+void World::meshChunk(Chunk &chunk) const {
+    const Chunk *neighbours[6];
+    for (int face = 0; face < 6; face++)
+        neighbours[face] = getChunk(chunk.position + FACE_OFFSETS[face]);
+    chunk.buildMesh(neighbours, registry);
+}
+
+void World::collectInFrustum(const frustum &frustum) {
+    for (const auto &entry : chunks) {
+        Chunk *chunk = entry.second.get();
+        if (frustum.isBoxVisible(chunk->getMin(), chunk->getMax()))
+            visibleChunks.push_back(chunk);
+    }
+}
+
+void World::updateVisibility(const glm::vec3 &cameraPosition, const glm::mat4 &viewProjection) {
+    PROFILE_SCOPE("Culling");
+    frameCounter++;
+    visibleChunks.clear();
+    lodCenter = cameraPosition;
+
+    frustum frustum(viewProjection);
+
+    Chunk *start = getChunk(worldToChunk(cameraPosition));
+    if (!connectivityCulling || start == nullptr) {
+        // outside of the generated area there is no graph to walk
+        collectInFrustum(frustum);
+        return;
+    }
+
+    struct Step {
+        Chunk *chunk;
+        // face through which the chunk was entered, -1 for the camera chunk
+        int entryFace;
+        // directions already travelled, the search never goes back towards the camera
+        uint8_t directions;
+    };
+
+    // every chunk is queued at most once, the queue never grows past the reserve
+    arena_vector<Step> queue(frame_arena::allocator<Step>());
+    queue.reserve(chunks.size());
+    start->visitedFrame = frameCounter;
+    visibleChunks.push_back(start);
+    queue.push_back({start, -1, 0});
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        Step step = queue[head];
+
+        for (int face = 0; face < 6; face++) {
+            if (step.directions & (1 << oppositeFace(face)))
+                continue;
+            if (step.entryFace >= 0 && !step.chunk->canSeeThrough(step.entryFace, face))
+                continue;
+
+            Chunk *next = getChunk(step.chunk->position + FACE_OFFSETS[face]);
+            if (next == nullptr || next->visitedFrame == frameCounter)
+                continue;
+            if (!frustum.isBoxVisible(next->getMin(), next->getMax()))
+                continue;
+
+            next->visitedFrame = frameCounter;
+            visibleChunks.push_back(next);
+            queue.push_back({next, oppositeFace(face), static_cast<uint8_t>(step.directions | (1 << face))});
+        }
+    }
+}
+
+int World::getChunkLod(const glm::ivec3 &position) const {
+    if (!lodEnabled)
+        return 0;
+
+    glm::vec3 center = (glm::vec3(position) + 0.5f) * static_cast<float>(CHUNK_SIZE);
+    float distance = glm::length(center - lodCenter) / static_cast<float>(CHUNK_SIZE);
+
+    int lod = 0;
+    float limit = lodDistance;
+    while (lod < CHUNK_LOD_COUNT - 1 && distance >= limit) {
+        lod++;
+        limit *= 2.0f;
+    }
+    return lod;
+}
+
+void World::draw() const {
+    PROFILE_SCOPE("World draw");
+    for (const Chunk *chunk : visibleChunks) {
+        int lod = getChunkLod(chunk->position);
+        if (chunk->meshes[lod].indexCount == 0)
+            continue;
+
+        // skirts are only drawn towards neighbours using another level, that is where cracks can appear
+        uint8_t skirtMask = 0;
+        for (int face = 0; face < 6; face++) {
+            glm::ivec3 neighbour = chunk->position + FACE_OFFSETS[face];
+            if (getChunkLod(neighbour) != lod && getChunk(neighbour) != nullptr)
+                skirtMask |= 1 << face;
+        }
+
+        chunk->meshes[lod].draw(skirtMask);
+    }
+    glBindVertexArray(0);
+}
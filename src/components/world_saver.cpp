@@ -0,0 +1,271 @@
+#include "VoxelEngine/components/world_saver.h"
+#include "VoxelEngine/utils/file_sync.h"
+#include "VoxelEngine/utils/profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <unordered_map>
+
+namespace {
+    void writeValue(std::vector<uint8_t> &bytes, uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8)
+            bytes.push_back(static_cast<uint8_t>(value >> shift));
+    }
+
+    bool readValue(const std::vector<uint8_t> &bytes, size_t &offset, uint32_t &value) {
+        if (bytes.size() - offset < 4)
+            return false;
+        value = bytes[offset] | (bytes[offset + 1] << 8) | (bytes[offset + 2] << 16) |
+                (static_cast<uint32_t>(bytes[offset + 3]) << 24);
+        offset += 4;
+        return true;
+    }
+
+    void writeVarint(std::vector<uint8_t> &bytes, size_t value) {
+        while (value >= 0x80) {
+            bytes.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    bool readVarint(const std::vector<uint8_t> &bytes, size_t &offset, size_t end, size_t &value) {
+        value = 0;
+        for (int shift = 0; shift <= 28; shift += 7) {
+            if (offset >= end)
+                return false;
+            uint8_t byte = bytes[offset++];
+            value |= static_cast<size_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // generated terrain is long runs of air and stone, a chunk usually takes a few hundred bytes
+    void encodeChunk(const ChunkVoxelArray &voxels, std::vector<uint8_t> &bytes) {
+        size_t start = 0;
+        while (start < voxels.size()) {
+            size_t end = start + 1;
+            while (end < voxels.size() && voxels[end] == voxels[start])
+                end++;
+            writeVarint(bytes, end - start);
+            bytes.push_back(voxels[start]);
+            start = end;
+        }
+    }
+
+    // the runs must cover the chunk exactly
+    bool decodeChunk(const std::vector<uint8_t> &bytes, size_t offset, size_t end, uint8_t *voxels) {
+        size_t index = 0;
+        while (offset < end) {
+            size_t length;
+            if (!readVarint(bytes, offset, end, length) || offset >= end || length > CHUNK_VOLUME - index)
+                return false;
+            std::memset(voxels + index, bytes[offset++], length);
+            index += length;
+        }
+        return index == CHUNK_VOLUME;
+    }
+}
+
+WorldSaver::WorldSaver(const std::string &directory)
+        : directory(directory) {
+    thread = std::thread([this] {
+        profiler::setThreadName("World saver");
+        saveLoop();
+    });
+}
+
+WorldSaver::~WorldSaver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    thread.join();
+}
+
+bool WorldSaver::save(WorldSnapshot snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (saving.load())
+            return false;
+        pending.reset(new WorldSnapshot(std::move(snapshot)));
+        saving = true;
+    }
+    condition.notify_one();
+    return true;
+}
+
+bool WorldSaver::isSaving() const {
+    return saving.load();
+}
+
+WorldSaveStats WorldSaver::getLastStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastStats;
+}
+
+std::vector<glm::ivec3> WorldSaver::takeFailedChunks() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<glm::ivec3> chunks;
+    chunks.swap(failedChunks);
+    return chunks;
+}
+
+glm::ivec3 WorldSaver::chunkToRegion(const glm::ivec3 &position) {
+    glm::ivec3 region;
+    for (int axis = 0; axis < 3; axis++) {
+        int p = position[axis];
+        region[axis] = (p >= 0 ? p : p - (REGION_SIZE - 1)) / REGION_SIZE;
+    }
+    return region;
+}
+
+std::string WorldSaver::getRegionPath(const glm::ivec3 &region) const {
+    return directory + "/region_" + std::to_string(region.x) + "_" + std::to_string(region.y) + "_" +
+           std::to_string(region.z) + ".vreg";
+}
+
+// a pending snapshot is still written when stopping, edits are not lost on exit
+void WorldSaver::saveLoop() {
+    while (true) {
+        std::unique_ptr<WorldSnapshot> snapshot;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopping || pending; });
+            if (!pending)
+                return;
+            snapshot = std::move(pending);
+        }
+        write(*snapshot);
+        // the arrays the world copied since are released here, on this thread
+        snapshot.reset();
+        saving = false;
+    }
+}
+
+void WorldSaver::write(const WorldSnapshot &snapshot) {
+    PROFILE_SCOPE("World save");
+    uint64_t start = profiler::now();
+    WorldSaveStats stats;
+
+    // the regions to rewrite and every chunk they hold
+    std::unordered_map<glm::ivec3, std::vector<const WorldSnapshot::Entry *>, ChunkKeyHash> regions;
+    for (const glm::ivec3 &position : snapshot.edited)
+        regions[chunkToRegion(position)];
+    for (const WorldSnapshot::Entry &entry : snapshot.chunks) {
+        auto it = regions.find(chunkToRegion(entry.position));
+        if (it != regions.end())
+            it->second.push_back(&entry);
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    std::vector<uint8_t> bytes;
+    std::vector<glm::ivec3> failedRegions;
+    for (const auto &region : regions) {
+        bytes.clear();
+        bytes.insert(bytes.end(), {'V', 'R', 'E', 'G'});
+        writeValue(bytes, REGION_FILE_VERSION);
+        writeValue(bytes, static_cast<uint32_t>(region.second.size()));
+        for (const WorldSnapshot::Entry *entry : region.second) {
+            for (int axis = 0; axis < 3; axis++)
+                writeValue(bytes, static_cast<uint32_t>(entry->position[axis]));
+            // the size is patched once the runs are written
+            size_t sizeOffset = bytes.size();
+            writeValue(bytes, 0);
+            encodeChunk(*entry->voxels, bytes);
+            uint32_t runBytes = static_cast<uint32_t>(bytes.size() - sizeOffset - 4);
+            for (int i = 0; i < 4; i++)
+                bytes[sizeOffset + i] = static_cast<uint8_t>(runBytes >> (8 * i));
+        }
+
+        std::string path = getRegionPath(region.first);
+        std::string temporary = path + ".tmp";
+        bool written;
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            written = file && file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size()) &&
+                      file.flush();
+        }
+        // the data must be on disk before the rename makes it the region, or a power loss could leave it empty
+        written = written && flushFileToDisk(temporary);
+        if (written) {
+            std::filesystem::rename(temporary, path, error);
+            written = !error;
+        }
+        if (!written) {
+            std::cout << "ERROR::WORLD_SAVER::FILE_NOT_WRITTEN: " << path << std::endl;
+            failedRegions.push_back(region.first);
+            continue;
+        }
+        stats.regionCount++;
+        stats.chunkCount += region.second.size();
+        stats.bytes += bytes.size();
+    }
+
+    // the renames only survive a power loss once the directory is synced, until then the edit log is still needed
+    if (stats.regionCount > 0 && !flushDirectoryToDisk(directory)) {
+        std::cout << "ERROR::WORLD_SAVER::DIRECTORY_NOT_SYNCED: " << directory << std::endl;
+        for (const auto &region : regions)
+            failedRegions.push_back(region.first);
+    }
+
+    stats.failed = !failedRegions.empty();
+    stats.milliseconds = static_cast<float>(profiler::now() - start) / 1000000.0f;
+    std::lock_guard<std::mutex> lock(mutex);
+    lastStats = stats;
+    for (const glm::ivec3 &position : snapshot.edited) {
+        if (std::find(failedRegions.begin(), failedRegions.end(), chunkToRegion(position)) != failedRegions.end())
+            failedChunks.push_back(position);
+    }
+}
+
+size_t WorldSaver::load(World &world) const {
+    PROFILE_SCOPE("World load");
+    std::error_code error;
+    std::filesystem::directory_iterator entries(directory, error);
+    if (error)
+        return 0;
+
+    size_t loaded = 0;
+    std::vector<uint8_t> voxels(CHUNK_VOLUME);
+    for (const std::filesystem::directory_entry &entry : entries) {
+        if (entry.path().extension() != ".vreg")
+            continue;
+        std::string path = entry.path().string();
+        std::ifstream file(path, std::ios::binary);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        size_t offset = 4;
+        uint32_t version, chunkCount;
+        if (bytes.size() < 4 || std::memcmp(bytes.data(), "VREG", 4) != 0 || !readValue(bytes, offset, version) ||
+            version != REGION_FILE_VERSION || !readValue(bytes, offset, chunkCount)) {
+            std::cout << "ERROR::WORLD_SAVER::INVALID_FILE: " << path << std::endl;
+            continue;
+        }
+
+        // a damaged chunk stops the region, the chunks read before it are kept
+        for (uint32_t i = 0; i < chunkCount; i++) {
+            uint32_t coordinates[3], runBytes;
+            if (!readValue(bytes, offset, coordinates[0]) || !readValue(bytes, offset, coordinates[1]) ||
+                !readValue(bytes, offset, coordinates[2]) || !readValue(bytes, offset, runBytes) ||
+                runBytes > bytes.size() - offset || !decodeChunk(bytes, offset, offset + runBytes, voxels.data())) {
+                std::cout << "ERROR::WORLD_SAVER::INVALID_CHUNK: " << path << std::endl;
+                break;
+            }
+            offset += runBytes;
+            glm::ivec3 position(static_cast<int32_t>(coordinates[0]), static_cast<int32_t>(coordinates[1]),
+                                static_cast<int32_t>(coordinates[2]));
+            if (world.loadChunk(position, voxels.data()))
+                loaded++;
+        }
+    }
+    return loaded;
+}
@@ -9,13 +9,35 @@
 
 #include <iostream>
 #include <vector>
-#include <numeric>
 #include <algorithm>
+#include <atomic>
+#include <random>
+#include "VoxelEngine/utils/file_watcher.h"
+#include "VoxelEngine/utils/frame_arena.h"
+#include "VoxelEngine/utils/frame_stats.h"
+#include "VoxelEngine/utils/gpu_timer.h"
+#include "VoxelEngine/utils/memory_tracker.h"
+#include "VoxelEngine/utils/profiler.h"
+#include "VoxelEngine/utils/profiler_overlay.h"
+#include "VoxelEngine/utils/program_cache.h"
 #include "VoxelEngine/utils/shader.h"
+#include "VoxelEngine/utils/shader_permutations.h"
+#include "VoxelEngine/utils/simulation_loop.h"
+#include "VoxelEngine/utils/slab_pool.h"
+#include "VoxelEngine/utils/uniform_buffer.h"
 #include "VoxelEngine/utils/stb_image.h"
 #include "VoxelEngine/utils/camera.h"
 #include "VoxelEngine/utils/texture.h"
 #include "VoxelEngine/components/cube.h"
+#include "VoxelEngine/components/block_registry.h"
+#include "VoxelEngine/components/edit_log.h"
+#include "VoxelEngine/components/entity_systems.h"
+#include "VoxelEngine/components/world.h"
+#include "VoxelEngine/components/world_saver.h"
+#include "VoxelEngine/components/clipmap.h"
+#include "VoxelEngine/components/voxel_physics.h"
+#include "VoxelEngine/utils/texture_loader.h"
+#include "VoxelEngine/utils/thread_pool.h"
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 
@@ -25,12 +47,46 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset);
 
-float calculateFPS(std::vector<float> &fpsValues, float &averageFPS, float &maxFps);
+void mouse_button_callback(GLFWwindow *window, int button, int action, int mods);
+
+// voxels modified per second by each kind of edit
+struct EditBenchmark {
+    bool done = false;
+    float setVoxelRate = 0.0f;
+    float fillRate = 0.0f;
+    float sphereRate = 0.0f;
+    float copyRate = 0.0f;
+    float pasteRate = 0.0f;
+};
+
+EditBenchmark runEditBenchmark(World &world, const glm::ivec3 &center);
+
+// bodies stepped per millisecond
+struct PhysicsBenchmark {
+    bool done = false;
+    float singleThreadRate = 0.0f;
+    float workerRate = 0.0f;
+};
+
+PhysicsBenchmark runPhysicsBenchmark(const VoxelPhysics &physics, thread_pool &pool, const glm::vec3 &center);
+
+// milliseconds of one simulation step of ENTITY_BENCHMARK_COUNT entities, motion and instance matrices
+struct EntityBenchmark {
+    bool done = false;
+    float singleThreadMilliseconds = 0.0f;
+    float workerMilliseconds = 0.0f;
+};
+
+EntityBenchmark runEntityBenchmark(thread_pool &pool);
+
 
 // settings
 const unsigned int SCR_WIDTH = 1280;
 const unsigned int SCR_HEIGHT = 720;
 
+// chunks generated around the origin in each horizontal direction, the clipmap draws the terrain beyond them
+const int WORLD_RADIUS = 6;
+
 // camera
 camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
 float lastX = SCR_WIDTH / 2.0f;
@@ -41,6 +97,56 @@ bool cameraLock = true;
 bool showSecondWindow = false;
 bool wireframeMode = false;
 bool drawingtype = false;
+bool fogEnabled = true;
+bool profilerEnabled = true;
+
+// voxel edits, left click breaks and right click places the aimed block
+enum Voxel_Edit {
+    EDIT_NONE,
+    EDIT_BREAK,
+    EDIT_PLACE
+};
+Voxel_Edit pendingEdit = EDIT_NONE;
+int placedBlock = BLOCK_STONE;
+const float EDIT_REACH = 8.0f;
+
+// the edited regions are written in the background every autosaveInterval seconds, or sooner when the edit log
+// grows past EDIT_LOG_COMPACT_BYTES
+bool autosaveEnabled = true;
+float autosaveInterval = 30.0f;
+bool saveRequested = false;
+
+// walking moves the camera as a physics body colliding with the world instead of flying through it
+bool walkMode = false;
+const float PLAYER_HALF_WIDTH = 0.3f;
+const float PLAYER_HEIGHT = 1.8f;
+const float PLAYER_EYE_HEIGHT = 1.6f;
+// a full voxel, the terrain is walked over without jumping
+const float PLAYER_STEP_HEIGHT = 1.0f;
+const float PLAYER_JUMP_SPEED = 8.0f;
+PhysicsBodies player;
+// feet position before the last simulation step, the camera is interpolated from it to the current one
+glm::vec3 previousPlayerPosition(0.0f);
+
+// the simulation runs at SIMULATION_RATE steps per second, on the render thread or on its own
+const float SIMULATION_RATE = 60.0f;
+bool simulationThreaded = false;
+
+// dynamic objects, moved by the simulation steps and drawn as instanced cubes. They bounce inside the box
+// around the camera where they were spawned
+EntityRegistry entities;
+int entitySpawnCount = 100000;
+uint32_t entitySeed = 1;
+glm::vec3 entityMin(0.0f), entityMax(0.0f);
+bool entitySystemsParallel = true;
+float entityMotionMilliseconds = 0.0f;
+float entityMatrixMilliseconds = 0.0f;
+const size_t ENTITY_BENCHMARK_COUNT = 100000;
+
+// feature bits of the chunk shader permutations, in the order of their defines
+enum Chunk_Shader_Feature {
+    CHUNK_SHADER_FOG = 1 << 0
+};
 
 // timing
 float deltaTime = 0.0f;    // time between current frame and last frame
@@ -71,6 +177,7 @@ int main() {
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSwapInterval(0);
 
     // Glad: load all OpenGL function pointers
@@ -79,6 +186,7 @@ int main() {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    program_cache::init((GLADloadproc) glfwGetProcAddress, "../cache/shaders");
 
     class shader shader("../resources/shaders/vertex.glsl", "../resources/shaders/fragment.glsl");
 
@@ -90,6 +198,67 @@ int main() {
 
     Cube cube(1.0f, texture.textureID);
 
+    uniform_buffer frameUniforms(sizeof(frame_data), FRAME_DATA_BINDING);
+
+    thread_pool threadPool;
+
+    // samplers never change, only the FrameData block is updated each frame
+    shader_permutations chunkShaders(threadPool, "../resources/shaders/chunk_vertex.glsl",
+                                     "../resources/shaders/chunk_fragment.glsl", {"FOG"}, [](class shader &program) {
+                program.set(program.getUniform<int>("blockTextures"), 0);
+            });
+    chunkShaders.request(0);
+    chunkShaders.request(CHUNK_SHADER_FOG);
+    texture_loader textureLoader(threadPool);
+
+    // one texture array layer per block material, BC1 when the driver has S3TC
+    BlockRegistry blocks;
+    blocks.registerDefaults();
+    blocks.buildTextures(16, textureLoader,
+                         isCompressedFormatSupported(BC_FORMAT_BC1) ? BC_FORMAT_BC1 : BC_FORMAT_NONE);
+
+    // shaders and block images are rebuilt when saved, a shader that fails to link keeps its previous program
+    file_watcher watcher;
+    int shaderWatch = -1;
+    shaderWatch = watcher.watch(shader.getFiles(), [&shader, &watcher, &shaderWatch]() {
+        shader.reload();
+        watcher.setPaths(shaderWatch, shader.getFiles());
+    });
+    chunkShaders.watch(watcher);
+    blocks.watchTextures(watcher, textureLoader);
+
+    World world(threadPool, blocks, WORLD_RADIUS, -4, 2);
+    world.generate();
+    // the saved regions replace the generated chunks, the rest of the world is generated identically
+    WorldSaver saver("../save");
+    saver.load(world);
+    // the edits logged after the last save, a crash loses at most the last sync interval
+    EditLog editLog("../save");
+    if (editLog.replay(world) > 0)
+        saveRequested = true;
+    world.editLog = &editLog;
+    float lastSave = static_cast<float>(glfwGetTime());
+    // log segment started with the snapshot being saved, the older ones are deleted once it is written
+    uint32_t savingSegment = 0;
+
+    VoxelPhysics physics(world);
+    player.add(camera.Position, PLAYER_HALF_WIDTH, PLAYER_HEIGHT, PLAYER_STEP_HEIGHT);
+    // steps read the world, the bodies and the entities, the render thread holds the simulation mutex to edit them
+    simulation_loop simulation(1.0f / SIMULATION_RATE, [&physics, &threadPool](float step) {
+        uint64_t start = profiler::now();
+        updateMotion(entities, entitySystemsParallel ? &threadPool : nullptr, step, entityMin, entityMax);
+        entityMotionMilliseconds = static_cast<float>(profiler::now() - start) / 1e6f;
+
+        if (!walkMode)
+            return;
+        previousPlayerPosition = player.getPosition(0);
+        physics.step(player, step);
+    });
+
+    // coarse rings around the full resolution world, up to the horizon
+    Clipmap clipmap(threadPool, blocks);
+    clipmap.setDetailRegion(world.getMin(), world.getMax());
+
     float i = 0;
 
     glEnable(GL_DEPTH_TEST);
@@ -104,9 +273,9 @@ int main() {
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
 
-    std::vector<float> fpsValues;
-    float averageFPS = 0.0f;
-    float maxFps = 0.0f;
+    // about 4 seconds of frames at 60 fps for the window statistics
+    frame_stats frameStats(256);
+    std::vector<float> recentFrames(frameStats.getCapacity());
 
     int size = 1;
 
@@ -132,9 +301,14 @@ int main() {
         }
     }
 
-    // Préparation du buffer d'instances
+    // the entity matrices follow the static ones, rebuilt every frame
+    size_t staticInstanceCount = modelMatrices.size();
+
+    // Préparation du buffer d'instances, one batch of the draw loop
+    int instanceCapacity = maxInstancedSize;
     glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-    glBufferData(GL_ARRAY_BUFFER, modelMatrices.size() * sizeof(glm::mat4), &modelMatrices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+    memory_tracker::trackGPU(GPU_BUFFER, instanceVBO, MEMORY_RENDERING, instanceCapacity * sizeof(glm::mat4));
 
     glBindVertexArray(cube.VAO);
 
@@ -149,18 +323,58 @@ int main() {
 
     // render loop
     // -----------
+    gpu_timer gpuTimer;
+    profiler_overlay overlay;
+    uint64_t lastFrameStart = 0;
+    std::vector<profile_event> frameEvents;
+    uint64_t lastAllocationCount = 0, frameAllocations = 0;
+    EditBenchmark editBenchmark;
+    PhysicsBenchmark physicsBenchmark;
+    EntityBenchmark entityBenchmark;
+
+    profiler::setThreadName("Main");
     while (!glfwWindowShouldClose(window)) {
+        // the zones of the previous frame are all closed here
+        if (lastFrameStart != 0) {
+            profiler::getThreadEvents(lastFrameStart, frameEvents);
+            overlay.addFrame(deltaTime * 1000.0f, frameEvents, gpuTimer.getLatest());
+        }
+        lastFrameStart = profiler::now();
+        // heap allocations of the main thread during the previous frame, 0 once everything has warmed up
+        uint64_t allocationCount = memory_tracker::getThreadAllocationCount();
+        frameAllocations = allocationCount - lastAllocationCount;
+        lastAllocationCount = allocationCount;
+        frame_arena::beginFrame();
+        gpuTimer.beginFrame();
+
+        PROFILE_SCOPE("Frame");
         // per-frame time logic
         // --------------------
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
-
-        float fps = calculateFPS(fpsValues, averageFPS, maxFps);
+        frameStats.push(deltaTime * 1000.0f);
 
         // input
         // -----
-        processInput(window);
+        {
+            PROFILE_SCOPE("Input");
+            std::lock_guard<std::mutex> lock(simulation.getMutex());
+            processInput(window);
+        }
+        simulation.setThreaded(simulationThreaded);
+        simulation.update();
+        {
+            std::lock_guard<std::mutex> lock(simulation.getMutex());
+            if (walkMode) {
+                glm::vec3 feet = glm::mix(previousPlayerPosition, player.getPosition(0), simulation.getAlpha());
+                camera.Position = feet + glm::vec3(0.0f, PLAYER_EYE_HEIGHT, 0.0f);
+            }
+        }
+
+        watcher.update();
+        textureLoader.update();
+        chunkShaders.update();
 
         // render
         // ------
@@ -170,28 +384,44 @@ int main() {
 
         glBeginQuery(GL_PRIMITIVES_GENERATED, queryID);
 
-        // draw our first triangle
-        shader.use();
-
-        shader.setVec3("camPos",camera.Position);
-
-        glm::vec3 lightpos = glm::vec3(0.0, 15.0, 0.0);
-        shader.setVec3("lightPos", lightpos);
-
+        // per frame values shared by every program through the FrameData block
         glm::mat4 proj = glm::perspective(glm::radians(camera.Zoom), (float) SCR_WIDTH / (float) SCR_HEIGHT, 0.1f,
                                           10000.0f);
-        shader.setMat4("projection", proj);
-
         glm::mat4 view = camera.GetViewMatrix();
-        shader.setMat4("view", view);
 
+        frame_data frame;
+        frame.view = view;
+        frame.projection = proj;
+        frame.camPos = glm::vec4(camera.Position, 1.0f);
+        frame.lightPos = glm::vec4(0.0f, 15.0f, 0.0f, 1.0f);
+        frameUniforms.update(&frame);
+
+        {
+            std::lock_guard<std::mutex> lock(simulation.getMutex());
+            uint64_t start = profiler::now();
+            modelMatrices.resize(staticInstanceCount);
+            appendInstanceMatrices(entities, entitySystemsParallel ? &threadPool : nullptr, modelMatrices);
+            entityMatrixMilliseconds = static_cast<float>(profiler::now() - start) / 1e6f;
+        }
+
+        // draw our first triangle
+        profile_scope cubeZone("Cube draw");
+        gpuTimer.begin("Cubes");
+        shader.use();
 
         glBindVertexArray(cube.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        maxInstancedSize = std::max(maxInstancedSize, 1);
+        if (maxInstancedSize != instanceCapacity) {
+            instanceCapacity = maxInstancedSize;
+            memory_tracker::trackGPU(GPU_BUFFER, instanceVBO, MEMORY_RENDERING, instanceCapacity * sizeof(glm::mat4));
+        }
         for (int i = 0; i < modelMatrices.size(); i += maxInstancedSize) {
             int count = std::min(maxInstancedSize, static_cast<int>(modelMatrices.size() - i));
 
-            // Mettre à jour les matrices de modèle pour ce lot
-            glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+            // Mettre à jour les matrices de modèle pour ce lot, in a fresh buffer so the upload does not wait for
+            // the draw of the previous batch
+            glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
             glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::mat4), &modelMatrices[i]);
 
             // Appel de rendu pour ce lot
@@ -199,22 +429,80 @@ int main() {
         }
 
         glBindVertexArray(0);
+        gpuTimer.end();
+        cubeZone.close();
+
+        class shader &chunkShader = chunkShaders.get(fogEnabled ? CHUNK_SHADER_FOG : 0);
+        chunkShader.use();
+        blocks.textures->bind(0);
+
+        if (pendingEdit != EDIT_NONE) {
+            std::lock_guard<std::mutex> lock(simulation.getMutex());
+            VoxelHit hit;
+            if (world.raycast(camera.Position, camera.Front, EDIT_REACH, hit)) {
+                if (pendingEdit == EDIT_BREAK)
+                    world.setVoxel(hit.voxel, BLOCK_AIR);
+                else if (hit.previous != hit.voxel)
+                    world.setVoxel(hit.previous, static_cast<uint8_t>(placedBlock));
+            }
+            pendingEdit = EDIT_NONE;
+        }
+        world.update();
+        for (float latency : world.getEditLatencies())
+            overlay.addEditLatency(latency);
+
+        // this thread only takes the snapshot, the saver thread writes it while the edits go on
+        if (!saver.isSaving()) {
+            // the log is only dropped once every region of the save and their renames are synced to disk
+            if (savingSegment != 0 && !saver.getLastStats().failed)
+                editLog.compact(savingSegment);
+            savingSegment = 0;
+            world.markUnsaved(saver.takeFailedChunks());
+            bool autosaveDue = (autosaveEnabled && currentFrame - lastSave >= autosaveInterval) ||
+                               editLog.getSize() >= EDIT_LOG_COMPACT_BYTES;
+            if ((saveRequested || autosaveDue) && world.getUnsavedCount() > 0) {
+                savingSegment = editLog.startSegment();
+                saver.save(world.createSnapshot());
+            }
+            if (saveRequested || autosaveDue)
+                lastSave = currentFrame;
+            saveRequested = false;
+        }
 
+        world.updateVisibility(camera.Position, proj * view);
+        gpuTimer.begin("World");
+        world.draw();
+        gpuTimer.end();
 
-
+        clipmap.update(camera.Position);
+        gpuTimer.begin("Clipmap");
+        clipmap.draw(proj * view);
+        gpuTimer.end();
 
         // End query
         glEndQuery(GL_PRIMITIVES_GENERATED);
 
-        // Get query result
+        // Get query result, waits for the GPU to finish the frame
+        profile_scope queryZone("Query readback");
         GLuint primitivesGenerated = 0;
         glGetQueryObjectuiv(queryID, GL_QUERY_RESULT, &primitivesGenerated);
+        queryZone.close();
 
+        profile_scope imguiZone("ImGui");
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
+        // the options edit the world and the player, the simulation waits until they are built
+        std::unique_lock<std::mutex> simulationLock(simulation.getMutex());
 
-        ImGui::SetNextWindowSize(ImVec2(325, 125));
+        // the GLFW backend forwards every key to ImGui, shortcuts work whichever window has the focus
+        if (io.KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_Z, false))
+            world.undo();
+        if (io.KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_Y, false))
+            world.redo();
+
+        // a height of 0 fits the content
+        ImGui::SetNextWindowSize(ImVec2(380, 0));
         ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
         ImGui::SetNextWindowBgAlpha(0.3);
         // Begin window with no title bar, no resize, no move, no scrollbar, no collapse, no nav, no background
@@ -225,15 +513,28 @@ int main() {
         ImGui::PushStyleColor(ImGuiCol_PlotLines, ImVec4(0.8f, 0.1f, 0.1f, 1.0f)); // Green line
         ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.0f, 0.0f, 0.0f, 0.3f));
 
+        frame_stats_summary stats = frameStats.getSummary();
+        size_t recentCount = frameStats.copyRecent(recentFrames.data(), recentFrames.size());
+
         ImGui::Begin("Performance", nullptr, window_flags);
-        ImGui::Text("FPS: %.1f", fps);
-        ImGui::PlotLines("FPS Over Time", fpsValues.data(), fpsValues.size(), 0, nullptr, 0.0f, maxFps + maxFps * 0.1,
-                         ImVec2(0, 80));
+        ImGui::Text("FPS: %.1f (%.2f ms)", stats.mean > 0.0f ? 1000.0f / stats.mean : 0.0f, stats.mean);
+        ImGui::PlotLines("Frame time", recentFrames.data(), static_cast<int>(recentCount), 0, nullptr, 0.0f,
+                         stats.max * 1.1f, ImVec2(0, 80));
 
         ImGui::PopStyleColor(2);
 
-        ImGui::Text("Average FPS: %.1f", averageFPS);
-        ImGui::Text("Max FPS: %.1f", maxFps);
+        ImGui::Text("Min %.2f  Max %.2f ms", stats.min, stats.max);
+        if (memory_tracker::isTrackingCPU())
+            ImGui::Text("Heap allocations: %llu per frame, frame arena %.1f KB", (unsigned long long) frameAllocations,
+                        frame_arena::get().getUsed() / 1024.0);
+        ImGui::Text("p50 %.2f  p95 %.2f  p99 %.2f ms (run)", stats.p50, stats.p95, stats.p99);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset"))
+            frameStats.resetPercentiles();
+
+        // per phase timings of every frame, GPU timings lag a few frames behind
+        if (ImGui::CollapsingHeader("Frame breakdown", ImGuiTreeNodeFlags_DefaultOpen))
+            overlay.draw();
         ImGui::End();
 
         if (showSecondWindow) {
@@ -243,8 +544,139 @@ int main() {
             ImGui::InputInt("Max draw per instance", &maxInstancedSize);
             ImGui::Text("Triangle render: %u", primitivesGenerated / 2);
             ImGui::Text("Instanced draw : %u", !drawingtype);
+            // the body starts from the camera, feet below the eyes
+            if (ImGui::Checkbox("Walk", &walkMode) && walkMode) {
+                glm::vec3 feet = camera.Position - glm::vec3(0.0f, PLAYER_EYE_HEIGHT, 0.0f);
+                player.positionX[0] = feet.x;
+                player.positionY[0] = feet.y;
+                player.positionZ[0] = feet.z;
+                player.velocityX[0] = player.velocityY[0] = player.velocityZ[0] = 0.0f;
+                previousPlayerPosition = feet;
+            }
+            ImGui::Checkbox("Simulation thread", &simulationThreaded);
+            ImGui::SameLine();
+            ImGui::Text("%llu steps, %.3f ms per step", (unsigned long long) simulation.getStepCount(),
+                        simulation.getStepMilliseconds());
+            ImGui::Checkbox("Cave culling", &world.connectivityCulling);
+            ImGui::Checkbox("Chunk LOD", &world.lodEnabled);
+            ImGui::Checkbox("Fog", &fogEnabled);
+            ImGui::SliderFloat("LOD distance", &world.lodDistance, 1.0f, 16.0f);
+            ImGui::Text("Chunks drawn : %zu / %zu", world.visibleChunks.size(), world.chunks.size());
+            ImGui::SliderInt("Placed block", &placedBlock, BLOCK_GRASS, BLOCK_STONE);
+            ImGui::Text("Chunks to remesh : %d", world.getRemeshPendingCount());
+            if (ImGui::Button("Undo"))
+                world.undo();
+            ImGui::SameLine();
+            if (ImGui::Button("Redo"))
+                world.redo();
+            ImGui::SameLine();
+            ImGui::Text("%zu / %zu steps, %.1f KB", world.journal.getUndoCount(), world.journal.getRedoCount(),
+                        world.journal.getMemoryUsage() / 1024.0);
+            if (ImGui::Button("Save edits"))
+                world.journal.save("../edits.journal");
+            ImGui::SameLine();
+            // the loaded steps are redone on top of the freshly generated terrain
+            if (ImGui::Button("Load edits") && world.journal.load("../edits.journal")) {
+                while (world.redo()) {
+                }
+            }
+            if (ImGui::Button("Save world"))
+                saveRequested = true;
+            ImGui::SameLine();
+            ImGui::Checkbox("Autosave", &autosaveEnabled);
+            ImGui::SliderFloat("Autosave interval", &autosaveInterval, 5.0f, 300.0f, "%.0f s");
+            WorldSaveStats saveStats = saver.getLastStats();
+            if (saver.isSaving())
+                ImGui::Text("Saving...");
+            else
+                ImGui::Text("%zu chunks unsaved, last save %zu regions %.1f KB in %.1f ms%s",
+                            world.getUnsavedCount(), saveStats.regionCount, saveStats.bytes / 1024.0,
+                            saveStats.milliseconds, saveStats.failed ? " (failed)" : "");
+            ImGui::Text("Edit log: %.1f KB, last sync %.2f ms", editLog.getSize() / 1024.0,
+                        editLog.getLastSyncMilliseconds());
+            if (ImGui::Button("Edit benchmark"))
+                editBenchmark = runEditBenchmark(world, glm::ivec3(glm::floor(camera.Position)));
+            if (editBenchmark.done) {
+                ImGui::Text("M voxels/s: setVoxel %.1f  box %.1f  sphere %.1f", editBenchmark.setVoxelRate / 1e6f,
+                            editBenchmark.fillRate / 1e6f, editBenchmark.sphereRate / 1e6f);
+                ImGui::Text("M voxels/s: copy %.1f  paste %.1f", editBenchmark.copyRate / 1e6f,
+                            editBenchmark.pasteRate / 1e6f);
+            }
+            if (ImGui::Button("Physics benchmark"))
+                physicsBenchmark = runPhysicsBenchmark(physics, threadPool, camera.Position);
+            if (physicsBenchmark.done)
+                ImGui::Text("Bodies per ms: %.0f on one thread, %.0f on the workers",
+                            physicsBenchmark.singleThreadRate, physicsBenchmark.workerRate);
+            ImGui::InputInt("Entities to spawn", &entitySpawnCount);
+            if (ImGui::Button("Spawn entities")) {
+                entityMin = camera.Position - glm::vec3(32.0f);
+                entityMax = camera.Position + glm::vec3(32.0f);
+                spawnMovingEntities(entities, static_cast<size_t>(std::max(entitySpawnCount, 0)), entityMin,
+                                    entityMax, 4.0f, entitySeed++);
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear entities"))
+                entities.clear();
+            ImGui::SameLine();
+            ImGui::Checkbox("Parallel systems", &entitySystemsParallel);
+            ImGui::Text("%zu entities, %zu archetypes: motion %.2f ms, matrices %.2f ms", entities.getEntityCount(),
+                        entities.getArchetypeCount(), entityMotionMilliseconds, entityMatrixMilliseconds);
+            if (ImGui::Button("Entity benchmark"))
+                entityBenchmark = runEntityBenchmark(threadPool);
+            if (entityBenchmark.done)
+                ImGui::Text("%zu entities, ms per step: %.2f on one thread, %.2f on the workers",
+                            ENTITY_BENCHMARK_COUNT, entityBenchmark.singleThreadMilliseconds,
+                            entityBenchmark.workerMilliseconds);
+            ImGui::Text("Clipmap chunks : %zu / %zu (%d pending)", clipmap.drawnChunks, clipmap.getChunkCount(),
+                        clipmap.getPendingCount());
+            if (ImGui::Checkbox("Profiler", &profilerEnabled))
+                profiler::setEnabled(profilerEnabled);
+            ImGui::SameLine();
+            if (ImGui::Button("Export trace"))
+                profiler::exportChromeTrace("../profile_trace.json");
+
+            // live bytes per subsystem, CPU columns stay empty when the allocation hooks are compiled out
+            if (ImGui::CollapsingHeader("Memory")) {
+                if (ImGui::BeginTable("memory", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                    ImGui::TableSetupColumn("Tag");
+                    ImGui::TableSetupColumn("CPU KB");
+                    ImGui::TableSetupColumn("Peak KB");
+                    ImGui::TableSetupColumn("Allocs");
+                    ImGui::TableSetupColumn("GPU KB");
+                    ImGui::TableHeadersRow();
+                    for (int tag = 0; tag < MEMORY_TAG_COUNT; tag++) {
+                        memory_tag_stats tagStats = memory_tracker::getStats(static_cast<memory_tag>(tag));
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(memory_tracker::getTagName(static_cast<memory_tag>(tag)));
+                        ImGui::TableNextColumn();
+                        if (memory_tracker::isTrackingCPU())
+                            ImGui::Text("%.1f", tagStats.cpuBytes / 1024.0);
+                        ImGui::TableNextColumn();
+                        if (memory_tracker::isTrackingCPU())
+                            ImGui::Text("%.1f", tagStats.cpuPeak / 1024.0);
+                        ImGui::TableNextColumn();
+                        if (memory_tracker::isTrackingCPU())
+                            ImGui::Text("%lld", static_cast<long long>(tagStats.cpuAllocations));
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.1f", tagStats.gpuBytes / 1024.0);
+                    }
+                    ImGui::EndTable();
+                }
+                size_t poolReserved = 0, poolFree = 0;
+                for (int sizeClass = 0; sizeClass < SLAB_CLASS_COUNT; sizeClass++) {
+                    slab_class_stats poolStats = slab_pool::getStats(sizeClass);
+                    poolReserved += poolStats.reservedBytes;
+                    poolFree += poolStats.pooledBytes;
+                }
+                ImGui::Text("Slab pools: %.1f KB in use / %.1f KB reserved", (poolReserved - poolFree) / 1024.0,
+                            poolReserved / 1024.0);
+                if (ImGui::Button("Dump memory"))
+                    memory_tracker::dump("../memory_dump.csv");
+            }
             ImGui::End();
         }
+        simulationLock.unlock();
 
         // Set wireframe mode
         if (wireframeMode) {
@@ -254,16 +686,34 @@ int main() {
         }
 
         ImGui::Render();
+        gpuTimer.begin("ImGui");
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        gpuTimer.end();
+        imguiZone.close();
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            PROFILE_SCOPE("Swap buffers");
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
 
         i++;
     }
 
+    simulation.setThreaded(false);
+
+    // the last edits are written before the saver is destroyed
+    while (saver.isSaving())
+        std::this_thread::yield();
+    world.markUnsaved(saver.takeFailedChunks());
+    if (world.getUnsavedCount() > 0)
+        saver.save(world.createSnapshot());
+
+    glDeleteBuffers(1, &instanceVBO);
+    memory_tracker::releaseGPU(GPU_BUFFER, instanceVBO);
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -274,20 +724,168 @@ int main() {
     return 0;
 }
 
+// runs every edit on a 64 voxel cube around the camera then pastes the original voxels back,
+// the chunks touched are remeshed once on the next update
+// ------------------------------------------------------------------------------------------
+EditBenchmark runEditBenchmark(World &world, const glm::ivec3 &center) {
+    const int half = 32;
+    const glm::ivec3 min = center - half, max = center + half;
+    auto rate = [](size_t voxels, uint64_t start) {
+        double seconds = static_cast<double>(profiler::now() - start) / 1e9;
+        return seconds > 0.0 ? static_cast<float>(static_cast<double>(voxels) / seconds) : 0.0f;
+    };
+    EditBenchmark result;
+    // a single undo step, it nets out to nothing
+    world.journal.beginStep();
+
+    VoxelRegion original;
+    uint64_t start = profiler::now();
+    world.copyRegion(min, max, original);
+    result.copyRate = rate(original.voxels.size(), start);
+
+    // alternating blocks so every pass changes every voxel
+    size_t changed = 0;
+    start = profiler::now();
+    for (int pass = 0; pass < 4; pass++)
+        changed += world.fillBox(min, max, pass % 2 == 0 ? BLOCK_STONE : BLOCK_DIRT);
+    result.fillRate = rate(changed, start);
+
+    start = profiler::now();
+    changed = world.fillSphere(glm::vec3(center), static_cast<float>(half), BLOCK_AIR);
+    result.sphereRate = rate(changed, start);
+
+    // the one voxel at a time path for comparison, inside the carved sphere
+    changed = 0;
+    start = profiler::now();
+    for (int z = -half / 2; z < half / 2; z++)
+        for (int y = -half / 2; y < half / 2; y++)
+            for (int x = -half / 2; x < half / 2; x++)
+                changed += world.setVoxel(center + glm::ivec3(x, y, z), BLOCK_STONE) ? 1 : 0;
+    result.setVoxelRate = rate(changed, start);
+
+    start = profiler::now();
+    changed = world.pasteRegion(original, min, false);
+    result.pasteRate = rate(changed, start);
+
+    world.journal.endStep();
+    result.done = true;
+    return result;
+}
+
+// drops 10000 bodies around the camera and steps them for two seconds, once on this thread and once split into
+// batches across the workers. The world is not edited meanwhile, the workers may read it
+// ----------------------------------------------------------------------------------------------------------
+PhysicsBenchmark runPhysicsBenchmark(const VoxelPhysics &physics, thread_pool &pool, const glm::vec3 &center) {
+    const int bodyCount = 10000;
+    const int frames = 120;
+    const size_t batchSize = 1024;
+    const float frameTime = 1.0f / 60.0f;
+
+    auto spawn = [&center](PhysicsBodies &bodies) {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> offset(-48.0f, 48.0f), speed(-3.0f, 3.0f);
+        bodies.clear();
+        for (int i = 0; i < bodyCount; i++) {
+            size_t body = bodies.add(center + glm::vec3(offset(random), 8.0f, offset(random)), 0.3f, 1.8f, 1.0f);
+            bodies.velocityX[body] = speed(random);
+            bodies.velocityZ[body] = speed(random);
+        }
+    };
+    auto rate = [](uint64_t start) {
+        double milliseconds = static_cast<double>(profiler::now() - start) / 1e6;
+        return milliseconds > 0.0 ? static_cast<float>(bodyCount * frames / milliseconds) : 0.0f;
+    };
+    PhysicsBenchmark result;
+    PhysicsBodies bodies;
+
+    spawn(bodies);
+    uint64_t start = profiler::now();
+    for (int frame = 0; frame < frames; frame++)
+        physics.step(bodies, frameTime);
+    result.singleThreadRate = rate(start);
+
+    spawn(bodies);
+    start = profiler::now();
+    for (int frame = 0; frame < frames; frame++) {
+        std::atomic<int> remaining{0};
+        for (size_t first = 0; first < bodies.size(); first += batchSize) {
+            size_t last = std::min(first + batchSize, bodies.size());
+            remaining++;
+            pool.enqueue([&physics, &bodies, &remaining, frameTime, first, last] {
+                physics.step(bodies, frameTime, first, last);
+                remaining--;
+            }, -1);
+        }
+        while (remaining.load() > 0)
+            std::this_thread::yield();
+    }
+    result.workerRate = rate(start);
+    result.done = true;
+    return result;
+}
+
+// steps ENTITY_BENCHMARK_COUNT moving entities for one second of 60 Hz steps, motion then instance matrices as a
+// frame does, once on this thread and once with the systems split across the workers
+// -------------------------------------------------------------------------------------------------------------
+EntityBenchmark runEntityBenchmark(thread_pool &pool) {
+    const int steps = 60;
+    const float stepTime = 1.0f / 60.0f;
+    const glm::vec3 min(-32.0f), max(32.0f);
+
+    auto run = [&](thread_pool *workers) {
+        EntityRegistry registry;
+        spawnMovingEntities(registry, ENTITY_BENCHMARK_COUNT, min, max, 4.0f, 42);
+        std::vector<glm::mat4> matrices;
+        matrices.reserve(ENTITY_BENCHMARK_COUNT);
+        uint64_t start = profiler::now();
+        for (int step = 0; step < steps; step++) {
+            updateMotion(registry, workers, stepTime, min, max);
+            matrices.clear();
+            appendInstanceMatrices(registry, workers, matrices);
+        }
+        return static_cast<float>(static_cast<double>(profiler::now() - start) / 1e6 / steps);
+    };
+    EntityBenchmark result;
+    result.singleThreadMilliseconds = run(nullptr);
+    result.workerMilliseconds = run(&pool);
+    result.done = true;
+    return result;
+}
+
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow *window) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        camera.ProcessKeyboard(FORWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        camera.ProcessKeyboard(BACKWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        camera.ProcessKeyboard(LEFT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        camera.ProcessKeyboard(RIGHT, deltaTime);
+    if (walkMode) {
+        // the keys pick the horizontal velocity, gravity keeps the vertical one
+        glm::vec3 forward = glm::normalize(glm::vec3(camera.Front.x, 0.0f, camera.Front.z));
+        glm::vec3 direction(0.0f);
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            direction += forward;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            direction -= forward;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            direction -= camera.Right;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            direction += camera.Right;
+        if (glm::dot(direction, direction) > 0.0f)
+            direction = glm::normalize(direction) * camera.MovementSpeed;
+        player.velocityX[0] = direction.x;
+        player.velocityZ[0] = direction.z;
+        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && player.onGround[0])
+            player.velocityY[0] = PLAYER_JUMP_SPEED;
+    } else {
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            camera.ProcessKeyboard(FORWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            camera.ProcessKeyboard(BACKWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            camera.ProcessKeyboard(LEFT, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            camera.ProcessKeyboard(RIGHT, deltaTime);
+    }
 
     if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS) {
         cameraLock = false;
@@ -339,37 +937,19 @@ void mouse_callback(GLFWwindow *window, double xposIn, double yposIn) {
     }
 }
 
+// glfw: edits only apply while the camera is controlled, the cursor is over the UI otherwise
+// ------------------------------------------------------------------------------------------
+void mouse_button_callback(GLFWwindow *, int button, int action, int) {
+    if (cameraLock || action != GLFW_PRESS)
+        return;
+    if (button == GLFW_MOUSE_BUTTON_LEFT)
+        pendingEdit = EDIT_BREAK;
+    else if (button == GLFW_MOUSE_BUTTON_RIGHT)
+        pendingEdit = EDIT_PLACE;
+}
+
 // glfw: whenever the mouse scroll wheel scrolls, this callback is called
 // ----------------------------------------------------------------------
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset) {
     camera.ProcessMouseScroll(static_cast<float>(yoffset));
 }
-
-float calculateFPS(std::vector<float> &fpsValues, float &averageFPS, float &maxFps) {
-    static float lastTime = glfwGetTime();
-    static int frameCount = 0;
-
-    float currentTime = glfwGetTime();
-    frameCount++;
-    float deltaTime = currentTime - lastTime;
-
-    if (deltaTime >= 1.0) {
-        float fps = frameCount / deltaTime;
-        fpsValues.push_back(fps);
-        if (fpsValues.size() > 50) {
-            fpsValues.erase(fpsValues.begin());
-        }
-
-        averageFPS = std::accumulate(fpsValues.begin(), fpsValues.end(), 0.0f) / fpsValues.size();
-
-        maxFps = *std::max_element(fpsValues.begin(), fpsValues.end());
-
-        lastTime = currentTime;
-        frameCount = 0;
-    }
-    if (fpsValues.size() > 0) {
-        return fpsValues[fpsValues.size() - 1];
-    } else {
-        return 0.0f;
-    }
-}
@@ -0,0 +1,443 @@
+#include "VoxelEngine/utils/bc_encoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // principal axis of the pixels through power iteration on their covariance matrix
+    void principalAxis(const unsigned char *rgba, int channels, float mean[4], float axis[4]) {
+        for (int c = 0; c < 4; c++)
+            mean[c] = 0.0f;
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < channels; c++)
+                mean[c] += rgba[i * 4 + c] / 16.0f;
+
+        float covariance[4][4] = {};
+        for (int i = 0; i < 16; i++) {
+            float d[4];
+            for (int c = 0; c < channels; c++)
+                d[c] = rgba[i * 4 + c] - mean[c];
+            for (int a = 0; a < channels; a++)
+                for (int b = 0; b < channels; b++)
+                    covariance[a][b] += d[a] * d[b];
+        }
+
+        float v[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        for (int iteration = 0; iteration < 8; iteration++) {
+            float next[4] = {};
+            for (int a = 0; a < channels; a++)
+                for (int b = 0; b < channels; b++)
+                    next[a] += covariance[a][b] * v[b];
+            float length = 0.0f;
+            for (int c = 0; c < channels; c++)
+                length += next[c] * next[c];
+            if (length < 1e-6f)
+                break;
+            length = std::sqrt(length);
+            for (int c = 0; c < channels; c++)
+                v[c] = next[c] / length;
+        }
+        for (int c = 0; c < 4; c++)
+            axis[c] = c < channels ? v[c] : 0.0f;
+    }
+
+    // pixels with the smallest and largest projection on the axis
+    void axisExtremes(const unsigned char *rgba, int channels, const float mean[4], const float axis[4],
+                      float low[4], float high[4]) {
+        float minT = 1e30f, maxT = -1e30f;
+        for (int i = 0; i < 16; i++) {
+            float t = 0.0f;
+            for (int c = 0; c < channels; c++)
+                t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+        for (int c = 0; c < 4; c++) {
+            low[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * minT));
+            high[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * maxT));
+        }
+    }
+
+    uint16_t packRGB565(const float color[4]) {
+        int r = static_cast<int>(std::lround(color[0] * 31.0f / 255.0f));
+        int g = static_cast<int>(std::lround(color[1] * 63.0f / 255.0f));
+        int b = static_cast<int>(std::lround(color[2] * 31.0f / 255.0f));
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpackRGB565(uint16_t packed, int color[3]) {
+        int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    // 4 colour palette of a BC1 block, in index order
+    void bc1Palette(uint16_t c0, uint16_t c1, int palette[4][3]) {
+        unpackRGB565(c0, palette[0]);
+        unpackRGB565(c1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+    }
+
+    // picks the closest palette entry of every pixel, returns the total squared error
+    int bc1Indices(const unsigned char *rgba, uint16_t c0, uint16_t c1, uint32_t &indices) {
+        int palette[4][3];
+        bc1Palette(c0, c1, palette);
+        indices = 0;
+        int total = 0;
+        for (int i = 0; i < 16; i++) {
+            int best = 0, bestError = 1 << 30;
+            for (int p = 0; p < 4; p++) {
+                int error = 0;
+                for (int c = 0; c < 3; c++) {
+                    int d = rgba[i * 4 + c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (i * 2);
+            total += bestError;
+        }
+        return total;
+    }
+
+    // least squares endpoints for the current indices
+    bool bc1Refine(const unsigned char *rgba, uint32_t indices, float e0[4], float e1[4]) {
+        const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        float aa = 0, bb = 0, ab = 0, ax[3] = {}, bx[3] = {};
+        for (int i = 0; i < 16; i++) {
+            float a = weights[(indices >> (i * 2)) & 3];
+            float b = 1.0f - a;
+            aa += a * a;
+            bb += b * b;
+            ab += a * b;
+            for (int c = 0; c < 3; c++) {
+                ax[c] += a * rgba[i * 4 + c];
+                bx[c] += b * rgba[i * 4 + c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) < 1e-6f)
+            return false;
+        for (int c = 0; c < 3; c++) {
+            e0[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) / determinant));
+            e1[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) / determinant));
+        }
+        return true;
+    }
+
+    // orders the endpoints for the 4 colour mode (c0 > c1), remapping the indices when they are swapped
+    void writeBC1(uint16_t c0, uint16_t c1, uint32_t indices, unsigned char *out) {
+        if (c0 < c1) {
+            std::swap(c0, c1);
+            // 0 <-> 1 and 2 <-> 3
+            indices ^= 0x55555555u;
+        } else if (c0 == c1) {
+            indices = 0;
+        }
+        out[0] = c0 & 0xFF;
+        out[1] = c0 >> 8;
+        out[2] = c1 & 0xFF;
+        out[3] = c1 >> 8;
+        for (int i = 0; i < 4; i++)
+            out[4 + i] = (indices >> (i * 8)) & 0xFF;
+    }
+
+    void encodeColorBlock(const unsigned char *rgba, unsigned char *out) {
+        float mean[4], axis[4], high[4], low[4];
+        principalAxis(rgba, 3, mean, axis);
+        axisExtremes(rgba, 3, mean, axis, low, high);
+
+        // inset the endpoints slightly, the extremes are usually outliers
+        for (int c = 0; c < 3; c++) {
+            float inset = (high[c] - low[c]) / 16.0f;
+            high[c] -= inset;
+            low[c] += inset;
+        }
+
+        uint16_t c0 = packRGB565(high), c1 = packRGB565(low);
+        uint32_t indices;
+        int error = bc1Indices(rgba, c0, c1, indices);
+
+        float e0[4], e1[4];
+        if (c0 != c1 && bc1Refine(rgba, indices, e0, e1)) {
+            uint16_t r0 = packRGB565(e0), r1 = packRGB565(e1);
+            uint32_t refinedIndices;
+            if (bc1Indices(rgba, r0, r1, refinedIndices) < error) {
+                c0 = r0;
+                c1 = r1;
+                indices = refinedIndices;
+            }
+        }
+        writeBC1(c0, c1, indices, out);
+    }
+
+    void bc3AlphaPalette(int a0, int a1, int palette[8]) {
+        palette[0] = a0;
+        palette[1] = a1;
+        for (int i = 2; i < 8; i++)
+            palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+    }
+
+    void encodeAlphaBlock(const unsigned char *rgba, unsigned char *out) {
+        int a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; i++) {
+            a0 = std::max(a0, static_cast<int>(rgba[i * 4 + 3]));
+            a1 = std::min(a1, static_cast<int>(rgba[i * 4 + 3]));
+        }
+
+        uint64_t indices = 0;
+        if (a0 != a1) {
+            int palette[8];
+            bc3AlphaPalette(a0, a1, palette);
+            for (int i = 0; i < 16; i++) {
+                int best = 0;
+                for (int p = 1; p < 8; p++) {
+                    if (std::abs(rgba[i * 4 + 3] - palette[p]) < std::abs(rgba[i * 4 + 3] - palette[best]))
+                        best = p;
+                }
+                indices |= static_cast<uint64_t>(best) << (i * 3);
+            }
+        }
+
+        out[0] = static_cast<unsigned char>(a0);
+        out[1] = static_cast<unsigned char>(a1);
+        for (int i = 0; i < 6; i++)
+            out[2 + i] = (indices >> (i * 8)) & 0xFF;
+    }
+
+    const int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    struct bit_writer {
+        unsigned char *out;
+        int position = 0;
+
+        void write(uint32_t value, int bits) {
+            for (int i = 0; i < bits; i++, position++) {
+                if ((value >> i) & 1)
+                    out[position / 8] |= 1 << (position % 8);
+            }
+        }
+    };
+
+    struct bit_reader {
+        const unsigned char *in;
+        int position = 0;
+
+        uint32_t read(int bits) {
+            uint32_t value = 0;
+            for (int i = 0; i < bits; i++, position++)
+                value |= static_cast<uint32_t>((in[position / 8] >> (position % 8)) & 1) << i;
+            return value;
+        }
+    };
+
+    // 7 bit endpoint plus a shared p-bit, picks the p-bit giving the smallest error
+    void quantizeBC7Endpoint(const float color[4], int quantized[4], int &pbit) {
+        int bestError = 1 << 30;
+        for (int p = 0; p < 2; p++) {
+            int q[4], error = 0;
+            for (int c = 0; c < 4; c++) {
+                q[c] = std::min(127, std::max(0, static_cast<int>(std::lround((color[c] - p) / 2.0f))));
+                int d = static_cast<int>(color[c]) - ((q[c] << 1) | p);
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                pbit = p;
+                std::copy(q, q + 4, quantized);
+            }
+        }
+    }
+}
+
+int bcBlockBytes(bc_format format) {
+    return format == BC_FORMAT_BC1 ? 8 : 16;
+}
+
+size_t bcLevelSize(bc_format format, int width, int height) {
+    return static_cast<size_t>(std::max(1, (width + 3) / 4)) * std::max(1, (height + 3) / 4) * bcBlockBytes(format);
+}
+
+void encodeBlockBC1(const unsigned char *rgba, unsigned char *out) {
+    encodeColorBlock(rgba, out);
+}
+
+void encodeBlockBC3(const unsigned char *rgba, unsigned char *out) {
+    encodeAlphaBlock(rgba, out);
+    encodeColorBlock(rgba, out + 8);
+}
+
+void encodeBlockBC7(const unsigned char *rgba, unsigned char *out) {
+    float mean[4], axis[4], high[4], low[4];
+    principalAxis(rgba, 4, mean, axis);
+    axisExtremes(rgba, 4, mean, axis, low, high);
+
+    int q0[4], q1[4], p0 = 0, p1 = 0;
+    quantizeBC7Endpoint(high, q0, p0);
+    quantizeBC7Endpoint(low, q1, p1);
+
+    int e0[4], e1[4];
+    for (int c = 0; c < 4; c++) {
+        e0[c] = (q0[c] << 1) | p0;
+        e1[c] = (q1[c] << 1) | p1;
+    }
+
+    int indices[16];
+    for (int i = 0; i < 16; i++) {
+        int best = 0, bestError = 1 << 30;
+        for (int w = 0; w < 16; w++) {
+            int error = 0;
+            for (int c = 0; c < 4; c++) {
+                int value = ((64 - BC7_WEIGHTS[w]) * e0[c] + BC7_WEIGHTS[w] * e1[c] + 32) >> 6;
+                int d = rgba[i * 4 + c] - value;
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                best = w;
+            }
+        }
+        indices[i] = best;
+    }
+
+    // the anchor index is stored without its top bit, swap the endpoints when it is set
+    if (indices[0] & 8) {
+        std::swap(q0, q1);
+        std::swap(p0, p1);
+        for (int &index : indices)
+            index = 15 - index;
+    }
+
+    std::memset(out, 0, 16);
+    bit_writer writer{out};
+    writer.write(1 << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        writer.write(q0[c], 7);
+        writer.write(q1[c], 7);
+    }
+    writer.write(p0, 1);
+    writer.write(p1, 1);
+    writer.write(indices[0], 3);
+    for (int i = 1; i < 16; i++)
+        writer.write(indices[i], 4);
+}
+
+void decodeBlock(bc_format format, const unsigned char *block, unsigned char *rgba) {
+    if (format == BC_FORMAT_BC7) {
+        bit_reader reader{block};
+        if (reader.read(7) != (1 << 6)) {
+            // only mode 6 is produced by the encoder
+            for (int i = 0; i < 16; i++) {
+                rgba[i * 4] = 255;
+                rgba[i * 4 + 1] = 0;
+                rgba[i * 4 + 2] = 255;
+                rgba[i * 4 + 3] = 255;
+            }
+            return;
+        }
+        int q[2][4];
+        for (int c = 0; c < 4; c++) {
+            q[0][c] = reader.read(7);
+            q[1][c] = reader.read(7);
+        }
+        int p0 = reader.read(1), p1 = reader.read(1);
+        for (int i = 0; i < 16; i++) {
+            int w = BC7_WEIGHTS[reader.read(i == 0 ? 3 : 4)];
+            for (int c = 0; c < 4; c++) {
+                int e0 = (q[0][c] << 1) | p0, e1 = (q[1][c] << 1) | p1;
+                rgba[i * 4 + c] = static_cast<unsigned char>(((64 - w) * e0 + w * e1 + 32) >> 6);
+            }
+        }
+        return;
+    }
+
+    const unsigned char *color = format == BC_FORMAT_BC3 ? block + 8 : block;
+    uint16_t c0 = color[0] | (color[1] << 8), c1 = color[2] | (color[3] << 8);
+    uint32_t indices = color[4] | (color[5] << 8) | (color[6] << 16) | (static_cast<uint32_t>(color[7]) << 24);
+    int palette[4][3];
+    bc1Palette(c0, c1, palette);
+    bool transparent = format == BC_FORMAT_BC1 && c0 <= c1;
+    if (transparent) {
+        // 3 colour mode, never produced by the encoder
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    for (int i = 0; i < 16; i++) {
+        int index = (indices >> (i * 2)) & 3;
+        for (int c = 0; c < 3; c++)
+            rgba[i * 4 + c] = static_cast<unsigned char>(palette[index][c]);
+        rgba[i * 4 + 3] = transparent && index == 3 ? 0 : 255;
+    }
+
+    if (format == BC_FORMAT_BC3) {
+        int alphas[8];
+        bc3AlphaPalette(block[0], block[1], alphas);
+        if (block[0] <= block[1]) {
+            // 6 alpha mode, never produced by the encoder
+            for (int i = 2; i < 6; i++)
+                alphas[i] = ((6 - i) * block[0] + (i - 1) * block[1]) / 5;
+            alphas[6] = 0;
+            alphas[7] = 255;
+        }
+        uint64_t alphaIndices = 0;
+        for (int i = 0; i < 6; i++)
+            alphaIndices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+        for (int i = 0; i < 16; i++)
+            rgba[i * 4 + 3] = static_cast<unsigned char>(alphas[(alphaIndices >> (i * 3)) & 7]);
+    }
+}
+
+std::vector<unsigned char> encodeImage(bc_format format, const unsigned char *rgba, int width, int height) {
+    std::vector<unsigned char> data(bcLevelSize(format, width, height));
+    int blocksX = std::max(1, (width + 3) / 4), blocksY = std::max(1, (height + 3) / 4);
+    int blockBytes = bcBlockBytes(format);
+
+    unsigned char block[64];
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            // pixels past the border repeat the last row/column
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    int sx = std::min(bx * 4 + x, width - 1), sy = std::min(by * 4 + y, height - 1);
+                    std::memcpy(&block[(x + y * 4) * 4], &rgba[(sx + sy * width) * 4], 4);
+                }
+            }
+
+            unsigned char *out = &data[(bx + by * blocksX) * blockBytes];
+            if (format == BC_FORMAT_BC1)
+                encodeBlockBC1(block, out);
+            else if (format == BC_FORMAT_BC3)
+                encodeBlockBC3(block, out);
+            else
+                encodeBlockBC7(block, out);
+        }
+    }
+    return data;
+}
+
+std::vector<unsigned char> decodeImage(bc_format format, const unsigned char *data, int width, int height) {
+    std::vector<unsigned char> rgba(width * height * 4);
+    int blocksX = std::max(1, (width + 3) / 4), blocksY = std::max(1, (height + 3) / 4);
+    int blockBytes = bcBlockBytes(format);
+
+    unsigned char block[64];
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            decodeBlock(format, &data[(bx + by * blocksX) * blockBytes], block);
+            for (int y = 0; y < 4 && by * 4 + y < height; y++) {
+                for (int x = 0; x < 4 && bx * 4 + x < width; x++)
+                    std::memcpy(&rgba[((bx * 4 + x) + (by * 4 + y) * width) * 4], &block[(x + y * 4) * 4], 4);
+            }
+        }
+    }
+    return rgba;
+}
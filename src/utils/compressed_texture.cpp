@@ -0,0 +1,81 @@
+#include "VoxelEngine/utils/compressed_texture.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    void writeValue(std::ofstream &file, uint32_t value) {
+        unsigned char bytes[4] = {static_cast<unsigned char>(value), static_cast<unsigned char>(value >> 8),
+                                  static_cast<unsigned char>(value >> 16), static_cast<unsigned char>(value >> 24)};
+        file.write(reinterpret_cast<const char *>(bytes), 4);
+    }
+
+    bool readValue(std::ifstream &file, uint32_t &value) {
+        unsigned char bytes[4];
+        if (!file.read(reinterpret_cast<char *>(bytes), 4))
+            return false;
+        value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+        return true;
+    }
+}
+
+bool writeCompressedTexture(const std::string &path, const compressed_image &image) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cout << "ERROR::COMPRESSED_TEXTURE::CANNOT_WRITE: " << path << std::endl;
+        return false;
+    }
+
+    file.write("VTEX", 4);
+    writeValue(file, COMPRESSED_TEXTURE_VERSION);
+    writeValue(file, image.format);
+    writeValue(file, static_cast<uint32_t>(image.width));
+    writeValue(file, static_cast<uint32_t>(image.height));
+    writeValue(file, static_cast<uint32_t>(image.levels.size()));
+    for (const std::vector<unsigned char> &level : image.levels) {
+        writeValue(file, static_cast<uint32_t>(level.size()));
+        file.write(reinterpret_cast<const char *>(level.data()), level.size());
+    }
+    return static_cast<bool>(file);
+}
+
+bool readCompressedTexture(const std::string &path, compressed_image &image) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    uint32_t version, format, width, height, levels;
+    if (!file.read(magic, 4) || std::memcmp(magic, "VTEX", 4) != 0 || !readValue(file, version) ||
+        version != COMPRESSED_TEXTURE_VERSION || !readValue(file, format) || !readValue(file, width) ||
+        !readValue(file, height) || !readValue(file, levels) || format < BC_FORMAT_BC1 || format > BC_FORMAT_BC7) {
+        std::cout << "ERROR::COMPRESSED_TEXTURE::INVALID_FILE: " << path << std::endl;
+        return false;
+    }
+    // checked before anything is allocated from the header, a full chain ends at 1x1
+    uint32_t maxLevels = 1;
+    while ((std::max(width, height) >> maxLevels) > 0)
+        maxLevels++;
+    if (width == 0 || height == 0 || width > COMPRESSED_TEXTURE_MAX_SIZE || height > COMPRESSED_TEXTURE_MAX_SIZE ||
+        levels == 0 || levels > maxLevels) {
+        std::cout << "ERROR::COMPRESSED_TEXTURE::INVALID_SIZE: " << path << std::endl;
+        return false;
+    }
+
+    image.format = static_cast<bc_format>(format);
+    image.width = static_cast<int>(width);
+    image.height = static_cast<int>(height);
+    image.levels.assign(levels, {});
+    for (uint32_t i = 0; i < levels; i++) {
+        uint32_t size;
+        int levelWidth = std::max(1, image.width >> i), levelHeight = std::max(1, image.height >> i);
+        if (!readValue(file, size) || size != bcLevelSize(image.format, levelWidth, levelHeight)) {
+            std::cout << "ERROR::COMPRESSED_TEXTURE::INVALID_LEVEL: " << path << std::endl;
+            return false;
+        }
+        image.levels[i].resize(size);
+        if (!file.read(reinterpret_cast<char *>(image.levels[i].data()), size)) {
+            std::cout << "ERROR::COMPRESSED_TEXTURE::TRUNCATED: " << path << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
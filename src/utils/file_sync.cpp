@@ -0,0 +1,41 @@
+#include "VoxelEngine/utils/file_sync.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool flushFileToDisk(const std::string &path) {
+#ifdef _WIN32
+    // _commit needs a file opened for writing
+    int file = _open(path.c_str(), _O_WRONLY | _O_BINARY);
+    if (file < 0)
+        return false;
+    bool synced = _commit(file) == 0;
+    _close(file);
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+    bool synced = fsync(file) == 0;
+    close(file);
+#endif
+    return synced;
+}
+
+bool flushDirectoryToDisk(const std::string &path) {
+#ifdef _WIN32
+    (void) path;
+    return true;
+#else
+    int directory = open(path.c_str(), O_RDONLY | O_DIRECTORY);
+    if (directory < 0)
+        return false;
+    bool synced = fsync(directory) == 0;
+    close(directory);
+    return synced;
+#endif
+}
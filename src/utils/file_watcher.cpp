@@ -0,0 +1,141 @@
+#include "VoxelEngine/utils/file_watcher.h"
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+file_watcher::file_watcher() : lastPoll(std::chrono::steady_clock::now()) {
+#ifdef __linux__
+    inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFD < 0)
+        std::cout << "inotify is not available, watched files are polled" << std::endl;
+#endif
+}
+
+file_watcher::~file_watcher() {
+#ifdef __linux__
+    if (inotifyFD >= 0)
+        close(inotifyFD);
+#endif
+}
+
+std::string file_watcher::normalize(const std::string &path) {
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(path, error);
+    return (error ? std::filesystem::path(path) : absolute).lexically_normal().generic_string();
+}
+
+std::filesystem::file_time_type file_watcher::getWriteTime(const std::string &path) {
+    std::error_code error;
+    std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+    return error ? std::filesystem::file_time_type::min() : time;
+}
+
+int file_watcher::watch(const std::vector<std::string> &paths, std::function<void()> callback) {
+    entry watched;
+    watched.callback = std::move(callback);
+    entries.push_back(std::move(watched));
+    int id = static_cast<int>(entries.size() - 1);
+    setPaths(id, paths);
+    return id;
+}
+
+void file_watcher::setPaths(int id, const std::vector<std::string> &paths) {
+    entry &watched = entries[id];
+    std::vector<std::string> previousPaths;
+    std::vector<std::filesystem::file_time_type> previousTimes;
+    previousPaths.swap(watched.paths);
+    previousTimes.swap(watched.writeTimes);
+
+    for (const std::string &path : paths) {
+        std::string normalized = normalize(path);
+        if (std::find(watched.paths.begin(), watched.paths.end(), normalized) != watched.paths.end())
+            continue;
+        // files already watched keep their time, a write made since the last poll is still seen
+        auto previous = std::find(previousPaths.begin(), previousPaths.end(), normalized);
+        watched.paths.push_back(normalized);
+        watched.writeTimes.push_back(previous != previousPaths.end() ? previousTimes[previous - previousPaths.begin()]
+                                                                     : getWriteTime(normalized));
+        if (inotifyFD >= 0)
+            watchDirectory(std::filesystem::path(normalized).parent_path().generic_string());
+    }
+}
+
+// editors often save by writing a new file and renaming it over the old one, so the directory is watched and
+// not the file itself
+void file_watcher::watchDirectory(const std::string &directory) {
+#ifdef __linux__
+    for (const auto &watched : directories)
+        if (watched.second == directory)
+            return;
+
+    int descriptor = inotify_add_watch(inotifyFD, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (descriptor < 0) {
+        std::cout << "ERROR::FILE_WATCHER::WATCH_FAILED: " << directory << std::endl;
+        return;
+    }
+    directories[descriptor] = directory;
+#endif
+}
+
+std::vector<std::string> file_watcher::readEvents() {
+    std::vector<std::string> changed;
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(inotifyFD, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+        for (char *position = buffer; position < buffer + length;) {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(position);
+            auto directory = directories.find(event->wd);
+            if (directory != directories.end() && event->len > 0)
+                changed.push_back(directory->second + "/" + event->name);
+            position += sizeof(inotify_event) + event->len;
+        }
+    }
+#endif
+    return changed;
+}
+
+void file_watcher::update() {
+    std::vector<entry *> triggered;
+
+    if (inotifyFD >= 0) {
+        std::vector<std::string> changed = readEvents();
+        for (entry &watched : entries) {
+            for (const std::string &path : watched.paths) {
+                if (std::find(changed.begin(), changed.end(), path) != changed.end()) {
+                    triggered.push_back(&watched);
+                    break;
+                }
+            }
+        }
+    } else {
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<float>(now - lastPoll).count() < pollInterval)
+            return;
+        lastPoll = now;
+
+        for (entry &watched : entries) {
+            bool modified = false;
+            for (size_t i = 0; i < watched.paths.size(); i++) {
+                std::filesystem::file_time_type time = getWriteTime(watched.paths[i]);
+                if (time != watched.writeTimes[i]) {
+                    watched.writeTimes[i] = time;
+                    modified = true;
+                }
+            }
+            if (modified)
+                triggered.push_back(&watched);
+        }
+    }
+
+    // the callbacks must not call watch, it would move the entries under the pointers. setPaths is fine
+    for (entry *watched : triggered)
+        watched->callback();
+}
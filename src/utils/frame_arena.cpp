@@ -0,0 +1,32 @@
+#include "VoxelEngine/utils/frame_arena.h"
+#include <memory>
+
+namespace {
+    size_t frameIndex = 0;
+
+    linear_arena &getFrameArena(size_t index) {
+        static std::unique_ptr<linear_arena> arenas[FRAME_ARENA_COUNT];
+        std::unique_ptr<linear_arena> &arena = arenas[index % FRAME_ARENA_COUNT];
+        if (!arena)
+            arena.reset(new linear_arena(FRAME_ARENA_SIZE));
+        return *arena;
+    }
+}
+
+void frame_arena::beginFrame() {
+    frameIndex++;
+    getFrameArena(frameIndex).reset();
+}
+
+linear_arena &frame_arena::get() {
+    return getFrameArena(frameIndex);
+}
+
+size_t frame_arena::getFrameIndex() {
+    return frameIndex;
+}
+
+linear_arena &scratch_arena::get() {
+    thread_local linear_arena arena(SCRATCH_ARENA_SIZE);
+    return arena;
+}
@@ -0,0 +1,182 @@
+#include "VoxelEngine/utils/frame_stats.h"
+#include <algorithm>
+
+p2_quantile::p2_quantile(float quantile) : quantile(quantile) {
+    reset();
+}
+
+void p2_quantile::reset() {
+    count = 0;
+    for (int i = 0; i < 5; i++) {
+        heights[i] = 0.0f;
+        positions[i] = static_cast<float>(i);
+    }
+    desired[0] = 0.0f;
+    desired[1] = 2.0f * quantile;
+    desired[2] = 4.0f * quantile;
+    desired[3] = 2.0f + 2.0f * quantile;
+    desired[4] = 4.0f;
+    increments[0] = 0.0f;
+    increments[1] = quantile / 2.0f;
+    increments[2] = quantile;
+    increments[3] = (1.0f + quantile) / 2.0f;
+    increments[4] = 1.0f;
+}
+
+float p2_quantile::parabolic(int i, float d) const {
+    return heights[i] + d / (positions[i + 1] - positions[i - 1]) *
+                        ((positions[i] - positions[i - 1] + d) * (heights[i + 1] - heights[i]) /
+                         (positions[i + 1] - positions[i]) +
+                         (positions[i + 1] - positions[i] - d) * (heights[i] - heights[i - 1]) /
+                         (positions[i] - positions[i - 1]));
+}
+
+float p2_quantile::linear(int i, int d) const {
+    return heights[i] + static_cast<float>(d) * (heights[i + d] - heights[i]) / (positions[i + d] - positions[i]);
+}
+
+void p2_quantile::add(float value) {
+    // the first five values are the initial markers
+    if (count < 5) {
+        heights[count++] = value;
+        if (count == 5)
+            std::sort(heights, heights + 5);
+        return;
+    }
+    count++;
+
+    int cell;
+    if (value < heights[0]) {
+        heights[0] = value;
+        cell = 0;
+    } else if (value >= heights[4]) {
+        heights[4] = value;
+        cell = 3;
+    } else {
+        cell = 0;
+        while (cell < 3 && value >= heights[cell + 1])
+            cell++;
+    }
+
+    for (int i = cell + 1; i < 5; i++)
+        positions[i] += 1.0f;
+    for (int i = 0; i < 5; i++)
+        desired[i] += increments[i];
+
+    // move the middle markers towards their desired positions
+    for (int i = 1; i < 4; i++) {
+        float d = desired[i] - positions[i];
+        if ((d >= 1.0f && positions[i + 1] - positions[i] > 1.0f) ||
+            (d <= -1.0f && positions[i - 1] - positions[i] < -1.0f)) {
+            int direction = d > 0.0f ? 1 : -1;
+            float height = parabolic(i, static_cast<float>(direction));
+            if (heights[i - 1] < height && height < heights[i + 1])
+                heights[i] = height;
+            else
+                heights[i] = linear(i, direction);
+            positions[i] += static_cast<float>(direction);
+        }
+    }
+}
+
+float p2_quantile::get() const {
+    if (count == 0)
+        return 0.0f;
+    if (count < 5) {
+        float sorted[5];
+        std::copy(heights, heights + count, sorted);
+        std::sort(sorted, sorted + count);
+        return sorted[std::min(count - 1, static_cast<int>(quantile * static_cast<float>(count)))];
+    }
+    return heights[2];
+}
+
+frame_stats::frame_stats(size_t capacity) : samples(std::max<size_t>(1, capacity)) {
+}
+
+size_t frame_stats::getCapacity() const {
+    return samples.size();
+}
+
+void frame_stats::push(float frameTime) {
+    uint64_t index = written.load(std::memory_order_relaxed);
+    size_t capacity = samples.size();
+
+    if (index >= capacity)
+        sum -= samples[index % capacity].load(std::memory_order_relaxed);
+    sum += frameTime;
+    samples[index % capacity].store(frameTime, std::memory_order_relaxed);
+    written.store(index + 1, std::memory_order_release);
+
+    // monotonic wedges, each frame enters and leaves them once so the window extremes cost constant amortized time
+    while (!maxWindow.empty() && maxWindow.back().second <= frameTime)
+        maxWindow.pop_back();
+    maxWindow.emplace_back(index, frameTime);
+    while (!minWindow.empty() && minWindow.back().second >= frameTime)
+        minWindow.pop_back();
+    minWindow.emplace_back(index, frameTime);
+    if (index >= capacity) {
+        uint64_t oldest = index + 1 - capacity;
+        if (maxWindow.front().first < oldest)
+            maxWindow.pop_front();
+        if (minWindow.front().first < oldest)
+            minWindow.pop_front();
+    }
+
+    p50.add(frameTime);
+    p95.add(frameTime);
+    p99.add(frameTime);
+
+    uint64_t frames = index + 1;
+    size_t windowSize = static_cast<size_t>(std::min<uint64_t>(frames, capacity));
+
+    uint32_t version = sequence.load(std::memory_order_relaxed);
+    sequence.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    publishedCount.store(frames, std::memory_order_relaxed);
+    publishedLast.store(frameTime, std::memory_order_relaxed);
+    publishedMean.store(static_cast<float>(sum / static_cast<double>(windowSize)), std::memory_order_relaxed);
+    publishedMin.store(minWindow.front().second, std::memory_order_relaxed);
+    publishedMax.store(maxWindow.front().second, std::memory_order_relaxed);
+    publishedP50.store(p50.get(), std::memory_order_relaxed);
+    publishedP95.store(p95.get(), std::memory_order_relaxed);
+    publishedP99.store(p99.get(), std::memory_order_relaxed);
+    sequence.store(version + 2, std::memory_order_release);
+}
+
+void frame_stats::resetPercentiles() {
+    p50.reset();
+    p95.reset();
+    p99.reset();
+}
+
+frame_stats_summary frame_stats::getSummary() const {
+    frame_stats_summary summary;
+    while (true) {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1u)
+            continue;
+        summary.frameCount = publishedCount.load(std::memory_order_relaxed);
+        summary.last = publishedLast.load(std::memory_order_relaxed);
+        summary.mean = publishedMean.load(std::memory_order_relaxed);
+        summary.min = publishedMin.load(std::memory_order_relaxed);
+        summary.max = publishedMax.load(std::memory_order_relaxed);
+        summary.p50 = publishedP50.load(std::memory_order_relaxed);
+        summary.p95 = publishedP95.load(std::memory_order_relaxed);
+        summary.p99 = publishedP99.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before)
+            return summary;
+    }
+}
+
+size_t frame_stats::copyRecent(float *output, size_t count) const {
+    size_t capacity = samples.size();
+    uint64_t end = written.load(std::memory_order_acquire);
+    // one slot is left out, the oldest one is the next the producer writes
+    uint64_t available = std::min<uint64_t>(end, capacity - 1);
+    size_t copied = static_cast<size_t>(std::min<uint64_t>(count, available));
+    for (size_t i = 0; i < copied; i++)
+        output[i] = samples[(end - copied + i) % capacity].load(std::memory_order_relaxed);
+    return copied;
+}
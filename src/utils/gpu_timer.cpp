@@ -0,0 +1,52 @@
+#include "VoxelEngine/utils/gpu_timer.h"
+
+gpu_timer::gpu_timer() {
+    for (frame_slot &slot : slots)
+        glGenQueries(GPU_TIMER_MAX_PHASES, slot.queries);
+}
+
+gpu_timer::~gpu_timer() {
+    for (frame_slot &slot : slots)
+        glDeleteQueries(GPU_TIMER_MAX_PHASES, slot.queries);
+}
+
+void gpu_timer::beginFrame() {
+    current = (current + 1) % GPU_TIMER_LATENCY;
+    frame_slot &slot = slots[current];
+
+    if (slot.count > 0) {
+        // queries complete in order, the last one being available means the whole frame is
+        GLint available = 0;
+        glGetQueryObjectiv(slot.queries[slot.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            latest.clear();
+            for (int i = 0; i < slot.count; i++) {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT, &elapsed);
+                latest.push_back({slot.names[i], static_cast<float>(elapsed) / 1000000.0f});
+            }
+        }
+    }
+    slot.count = 0;
+}
+
+void gpu_timer::begin(const char *name) {
+    frame_slot &slot = slots[current];
+    if (active || slot.count >= GPU_TIMER_MAX_PHASES)
+        return;
+    slot.names[slot.count] = name;
+    glBeginQuery(GL_TIME_ELAPSED, slot.queries[slot.count]);
+    active = true;
+}
+
+void gpu_timer::end() {
+    if (!active)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    slots[current].count++;
+    active = false;
+}
+
+const std::vector<phase_time> &gpu_timer::getLatest() const {
+    return latest;
+}
@@ -0,0 +1,82 @@
+#include "VoxelEngine/utils/linear_arena.h"
+#include "VoxelEngine/utils/memory_tracker.h"
+#include <algorithm>
+#include <cstdint>
+
+linear_arena::linear_arena(size_t capacity) {
+    addBlock(std::max<size_t>(capacity, 64));
+}
+
+linear_arena::~linear_arena() {
+    releaseBlocks(0);
+}
+
+void linear_arena::addBlock(size_t size) {
+    MEMORY_SCOPE(MEMORY_ARENAS);
+    blocks.push_back({new unsigned char[size], size});
+}
+
+void linear_arena::releaseBlocks(size_t keep) {
+    while (blocks.size() > keep) {
+        delete[] blocks.back().data;
+        blocks.pop_back();
+    }
+}
+
+void *linear_arena::allocate(size_t size, size_t alignment) {
+    block *current = &blocks.back();
+    uintptr_t base = reinterpret_cast<uintptr_t>(current->data);
+    size_t start = ((base + offset + alignment - 1) & ~(uintptr_t) (alignment - 1)) - base;
+    if (start + size > current->size) {
+        // the full block stays alive, pointers into it are still in use
+        committed += offset;
+        addBlock(std::max(current->size * 2, size + alignment));
+        current = &blocks.back();
+        base = reinterpret_cast<uintptr_t>(current->data);
+        offset = 0;
+        start = ((base + alignment - 1) & ~(uintptr_t) (alignment - 1)) - base;
+    }
+
+    offset = start + size;
+    peak = std::max(peak, committed + offset);
+    return current->data + start;
+}
+
+void linear_arena::reset() {
+    // rewinding may already have freed the overflow blocks, the peak still remembers them
+    if (blocks.size() > 1 || blocks.front().size < peak) {
+        releaseBlocks(0);
+        addBlock(peak);
+    }
+    offset = 0;
+    committed = 0;
+}
+
+linear_arena::marker linear_arena::getMarker() const {
+    return {blocks.size() - 1, offset, committed};
+}
+
+void linear_arena::rewind(const marker &position) {
+    if (position.block == 0 && position.offset == 0) {
+        reset();
+        return;
+    }
+    releaseBlocks(position.block + 1);
+    offset = position.offset;
+    committed = position.committed;
+}
+
+size_t linear_arena::getUsed() const {
+    return committed + offset;
+}
+
+size_t linear_arena::getPeak() const {
+    return peak;
+}
+
+size_t linear_arena::getCapacity() const {
+    size_t capacity = 0;
+    for (const block &current : blocks)
+        capacity += current.size;
+    return capacity;
+}
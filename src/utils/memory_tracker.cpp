@@ -0,0 +1,292 @@
+#include "VoxelEngine/utils/memory_tracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+    // constant initialized, the hooks can run before any dynamic initializer
+    std::atomic<int64_t> cpuBytes[MEMORY_TAG_COUNT];
+    std::atomic<int64_t> cpuPeak[MEMORY_TAG_COUNT];
+    std::atomic<int64_t> cpuAllocations[MEMORY_TAG_COUNT];
+    std::atomic<int64_t> gpuBytes[MEMORY_TAG_COUNT];
+    std::atomic<int64_t> gpuPeak[MEMORY_TAG_COUNT];
+
+    thread_local memory_tag threadTag = MEMORY_UNTAGGED;
+    thread_local uint64_t threadAllocations = 0;
+
+    struct gpu_object {
+        memory_tag tag;
+        size_t bytes;
+    };
+
+    std::mutex &getGPUMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    std::map<std::pair<int, unsigned int>, gpu_object> &getGPUObjects() {
+        static std::map<std::pair<int, unsigned int>, gpu_object> objects;
+        return objects;
+    }
+
+    void raisePeak(std::atomic<int64_t> &peak, int64_t value) {
+        int64_t current = peak.load(std::memory_order_relaxed);
+        while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    const char *TAG_NAMES[MEMORY_TAG_COUNT] = {"Untagged", "Chunks", "Meshes", "Textures", "Rendering", "Profiler",
+                                               "Arenas", "Pools", "Entities"};
+}
+
+bool memory_tracker::isTrackingCPU() {
+#ifdef VOXELENGINE_TRACK_MEMORY
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *memory_tracker::getTagName(memory_tag tag) {
+    return tag < MEMORY_TAG_COUNT ? TAG_NAMES[tag] : "Invalid";
+}
+
+memory_tag memory_tracker::getThreadTag() {
+    return threadTag;
+}
+
+void memory_tracker::setThreadTag(memory_tag tag) {
+    threadTag = tag;
+}
+
+uint64_t memory_tracker::getThreadAllocationCount() {
+    return threadAllocations;
+}
+
+void memory_tracker::trackCPU(memory_tag tag, int64_t bytes, int64_t allocations) {
+    int64_t total = cpuBytes[tag].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    cpuAllocations[tag].fetch_add(allocations, std::memory_order_relaxed);
+    if (bytes > 0)
+        raisePeak(cpuPeak[tag], total);
+}
+
+void memory_tracker::trackGPU(gpu_resource resource, unsigned int id, memory_tag tag, size_t bytes) {
+    std::lock_guard<std::mutex> lock(getGPUMutex());
+    gpu_object &object = getGPUObjects()[{resource, id}];
+    if (object.bytes > 0)
+        gpuBytes[object.tag].fetch_sub(static_cast<int64_t>(object.bytes), std::memory_order_relaxed);
+    object = {tag, bytes};
+    int64_t total = gpuBytes[tag].fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) +
+                    static_cast<int64_t>(bytes);
+    raisePeak(gpuPeak[tag], total);
+}
+
+void memory_tracker::releaseGPU(gpu_resource resource, unsigned int id) {
+    std::lock_guard<std::mutex> lock(getGPUMutex());
+    auto &objects = getGPUObjects();
+    auto it = objects.find({resource, id});
+    if (it == objects.end())
+        return;
+    gpuBytes[it->second.tag].fetch_sub(static_cast<int64_t>(it->second.bytes), std::memory_order_relaxed);
+    objects.erase(it);
+}
+
+memory_tag_stats memory_tracker::getStats(memory_tag tag) {
+    memory_tag_stats stats;
+    stats.cpuBytes = cpuBytes[tag].load(std::memory_order_relaxed);
+    stats.cpuPeak = cpuPeak[tag].load(std::memory_order_relaxed);
+    stats.cpuAllocations = cpuAllocations[tag].load(std::memory_order_relaxed);
+    stats.gpuBytes = gpuBytes[tag].load(std::memory_order_relaxed);
+    stats.gpuPeak = gpuPeak[tag].load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool memory_tracker::dump(const std::string &path) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        std::cout << "ERROR::MEMORY_TRACKER::FILE_NOT_WRITTEN: " << path << std::endl;
+        return false;
+    }
+
+    file << "tag,cpu_bytes,cpu_peak,cpu_allocations,gpu_bytes,gpu_peak\n";
+    for (int tag = 0; tag < MEMORY_TAG_COUNT; tag++) {
+        memory_tag_stats stats = getStats(static_cast<memory_tag>(tag));
+        file << TAG_NAMES[tag] << "," << stats.cpuBytes << "," << stats.cpuPeak << "," << stats.cpuAllocations << ","
+             << stats.gpuBytes << "," << stats.gpuPeak << "\n";
+    }
+
+    std::vector<std::pair<std::pair<int, unsigned int>, gpu_object>> objects;
+    {
+        std::lock_guard<std::mutex> lock(getGPUMutex());
+        objects.assign(getGPUObjects().begin(), getGPUObjects().end());
+    }
+    std::sort(objects.begin(), objects.end(), [](const auto &a, const auto &b) {
+        return a.second.bytes > b.second.bytes;
+    });
+
+    file << "\nresource,id,tag,bytes\n";
+    for (const auto &object : objects) {
+        file << (object.first.first == GPU_BUFFER ? "buffer" : "texture") << "," << object.first.second << ","
+             << TAG_NAMES[object.second.tag] << "," << object.second.bytes << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+#ifdef VOXELENGINE_TRACK_MEMORY
+namespace {
+    // keeps the 16 byte alignment malloc gives
+    struct alignas(16) allocation_header {
+        uint64_t size;
+        memory_tag tag;
+    };
+    static_assert(sizeof(allocation_header) == 16, "the header must keep the alignment of malloc");
+
+    void *trackedAllocate(size_t size) {
+        allocation_header *header = static_cast<allocation_header *>(std::malloc(sizeof(allocation_header) + size));
+        if (!header)
+            return nullptr;
+        header->size = size;
+        header->tag = threadTag;
+        threadAllocations++;
+        memory_tracker::trackCPU(header->tag, static_cast<int64_t>(size), 1);
+        return header + 1;
+    }
+
+    void trackedFree(void *pointer) {
+        if (!pointer)
+            return;
+        allocation_header *header = static_cast<allocation_header *>(pointer) - 1;
+        memory_tracker::trackCPU(header->tag, -static_cast<int64_t>(header->size), -1);
+        std::free(header);
+    }
+
+    // over-aligned blocks are padded to the alignment, the header right before the block points back to the malloc
+    struct aligned_header {
+        void *block;
+        uint64_t size;
+        memory_tag tag;
+    };
+
+    void *trackedAllocateAligned(size_t size, std::align_val_t alignment) {
+        size_t align = std::max(static_cast<size_t>(alignment), alignof(aligned_header));
+        void *block = std::malloc(sizeof(aligned_header) + align - 1 + size);
+        if (!block)
+            return nullptr;
+        uintptr_t address = reinterpret_cast<uintptr_t>(block) + sizeof(aligned_header);
+        address = (address + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        aligned_header *header = reinterpret_cast<aligned_header *>(address) - 1;
+        header->block = block;
+        header->size = size;
+        header->tag = threadTag;
+        threadAllocations++;
+        memory_tracker::trackCPU(header->tag, static_cast<int64_t>(size), 1);
+        return reinterpret_cast<void *>(address);
+    }
+
+    void trackedFreeAligned(void *pointer) {
+        if (!pointer)
+            return;
+        aligned_header *header = static_cast<aligned_header *>(pointer) - 1;
+        memory_tracker::trackCPU(header->tag, -static_cast<int64_t>(header->size), -1);
+        std::free(header->block);
+    }
+}
+
+void *operator new(std::size_t size) {
+    void *pointer = trackedAllocate(size);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](std::size_t size) {
+    void *pointer = trackedAllocate(size);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return trackedAllocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return trackedAllocate(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    trackedFree(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    trackedFree(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    trackedFree(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    trackedFree(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+    trackedFree(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+    trackedFree(pointer);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    void *pointer = trackedAllocateAligned(size, alignment);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    void *pointer = trackedAllocateAligned(size, alignment);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return trackedAllocateAligned(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return trackedAllocateAligned(size, alignment);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+    trackedFreeAligned(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+    trackedFreeAligned(pointer);
+}
+
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept {
+    trackedFreeAligned(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept {
+    trackedFreeAligned(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t &) noexcept {
+    trackedFreeAligned(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t &) noexcept {
+    trackedFreeAligned(pointer);
+}
+#endif
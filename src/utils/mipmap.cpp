@@ -0,0 +1,138 @@
+#include "VoxelEngine/utils/mipmap.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VOXELENGINE_MIPMAP_SSE2
+#endif
+
+namespace {
+    // sRGB <-> linear tables, the inverse one is indexed by linear * (LINEAR_STEPS - 1)
+    const int LINEAR_STEPS = 4096;
+
+    struct srgb_tables {
+        float toLinear[256];
+        unsigned char toSrgb[LINEAR_STEPS];
+
+        srgb_tables() {
+            for (int i = 0; i < 256; i++) {
+                float c = i / 255.0f;
+                toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            for (int i = 0; i < LINEAR_STEPS; i++) {
+                float l = i / static_cast<float>(LINEAR_STEPS - 1);
+                float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                toSrgb[i] = static_cast<unsigned char>(std::min(255.0f, c * 255.0f + 0.5f));
+            }
+        }
+    };
+
+    const srgb_tables &tables() {
+        static const srgb_tables instance;
+        return instance;
+    }
+
+    // rounded 2x2 average of one destination pixel from its top left, top right, bottom left and bottom right
+    // sources. With srgb the colour channels are averaged in linear space, alpha always is as stored
+    void averagePixel(const unsigned char *a, const unsigned char *b, const unsigned char *c, const unsigned char *d,
+                      bool srgb, unsigned char *out) {
+        for (int i = 0; i < 4; i++)
+            out[i] = static_cast<unsigned char>((a[i] + b[i] + c[i] + d[i] + 2) >> 2);
+        if (!srgb)
+            return;
+
+        const srgb_tables &t = tables();
+        for (int i = 0; i < 3; i++) {
+            float v = ((t.toLinear[a[i]] + t.toLinear[b[i]]) + (t.toLinear[c[i]] + t.toLinear[d[i]])) * 0.25f;
+            v = std::min(1.0f, std::max(0.0f, v));
+            out[i] = t.toSrgb[static_cast<int>(v * (LINEAR_STEPS - 1) + 0.5f)];
+        }
+    }
+
+#ifdef VOXELENGINE_MIPMAP_SSE2
+    // four destination pixels from eight pixels of the top and bottom source rows, same results as averagePixel
+    void averageFourPixels(const unsigned char *top, const unsigned char *bottom, bool srgb, unsigned char *out) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i averages[2];
+        for (int half = 0; half < 2; half++) {
+            __m128i upper = _mm_loadu_si128(reinterpret_cast<const __m128i *>(top + half * 16));
+            __m128i lower = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + half * 16));
+            // vertical sums in 16 bits, two source pixels per 64 bit half
+            __m128i left = _mm_add_epi16(_mm_unpacklo_epi8(upper, zero), _mm_unpacklo_epi8(lower, zero));
+            __m128i right = _mm_add_epi16(_mm_unpackhi_epi8(upper, zero), _mm_unpackhi_epi8(lower, zero));
+            // adding the pixel pairs leaves one destination pixel per 64 bit half
+            __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(left, right), _mm_unpackhi_epi64(left, right));
+            averages[half] = _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(averages[0], averages[1]));
+        if (!srgb)
+            return;
+
+        // the lookups stay scalar, SSE2 has no gather. One channel of the four pixels per vector
+        const srgb_tables &t = tables();
+        const float *linear = t.toLinear;
+        for (int i = 0; i < 3; i++) {
+            const unsigned char *u = top + i, *l = bottom + i;
+            __m128 a = _mm_setr_ps(linear[u[0]], linear[u[8]], linear[u[16]], linear[u[24]]);
+            __m128 b = _mm_setr_ps(linear[u[4]], linear[u[12]], linear[u[20]], linear[u[28]]);
+            __m128 c = _mm_setr_ps(linear[l[0]], linear[l[8]], linear[l[16]], linear[l[24]]);
+            __m128 d = _mm_setr_ps(linear[l[4]], linear[l[12]], linear[l[20]], linear[l[28]]);
+            __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(c, d)), _mm_set1_ps(0.25f));
+            v = _mm_min_ps(_mm_set1_ps(1.0f), _mm_max_ps(_mm_setzero_ps(), v));
+            v = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(static_cast<float>(LINEAR_STEPS - 1))), _mm_set1_ps(0.5f));
+
+            alignas(16) int indices[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(indices), _mm_cvttps_epi32(v));
+            for (int p = 0; p < 4; p++)
+                out[p * 4 + i] = t.toSrgb[indices[p]];
+        }
+    }
+#endif
+
+    // averages the 2x2 footprint of every destination pixel, odd sizes clamp to the last row/column
+    image_level downsample(const image_level &source, bool srgb) {
+        image_level level;
+        level.width = std::max(1, source.width / 2);
+        level.height = std::max(1, source.height / 2);
+        level.pixels.resize(level.width * level.height * 4);
+
+        for (int y = 0; y < level.height; y++) {
+            const unsigned char *top = &source.pixels[std::min(y * 2, source.height - 1) * source.width * 4];
+            const unsigned char *bottom = &source.pixels[std::min(y * 2 + 1, source.height - 1) * source.width * 4];
+            unsigned char *out = &level.pixels[y * level.width * 4];
+
+            int x = 0;
+#ifdef VOXELENGINE_MIPMAP_SSE2
+            // the clamped last column of odd widths is left to the scalar loop
+            for (; x + 4 <= level.width && (x + 4) * 2 <= source.width; x += 4)
+                averageFourPixels(top + x * 8, bottom + x * 8, srgb, out + x * 4);
+#endif
+            for (; x < level.width; x++) {
+                int x0 = std::min(x * 2, source.width - 1) * 4;
+                int x1 = std::min(x * 2 + 1, source.width - 1) * 4;
+                averagePixel(top + x0, top + x1, bottom + x0, bottom + x1, srgb, out + x * 4);
+            }
+        }
+        return level;
+    }
+}
+
+image_level resizeImage(const unsigned char *rgba, int width, int height, int newWidth, int newHeight) {
+    image_level level{newWidth, newHeight, std::vector<unsigned char>(newWidth * newHeight * 4)};
+    for (int y = 0; y < newHeight; y++) {
+        for (int x = 0; x < newWidth; x++) {
+            const unsigned char *source = &rgba[((x * width / newWidth) + (y * height / newHeight) * width) * 4];
+            std::copy(source, source + 4, &level.pixels[(x + y * newWidth) * 4]);
+        }
+    }
+    return level;
+}
+
+std::vector<image_level> generateMipChain(const unsigned char *rgba, int width, int height, bool srgb) {
+    std::vector<image_level> levels;
+    levels.push_back({width, height, std::vector<unsigned char>(rgba, rgba + width * height * 4)});
+    while (levels.back().width > 1 || levels.back().height > 1)
+        levels.push_back(downsample(levels.back(), srgb));
+    return levels;
+}
@@ -0,0 +1,202 @@
+#include "VoxelEngine/utils/profiler.h"
+#include "VoxelEngine/utils/memory_tracker.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace {
+    // One ring entry. Other threads copy it while the owner may be overwriting it, so every field is atomic and
+    // sequence says which zone the slot holds: 2 * index + 1 while zone index is written, 2 * index + 2 once done.
+    // A reader keeps its copy only when sequence was the expected even value both before and after it
+    struct profile_slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<const char *> name{nullptr};
+        std::atomic<uint64_t> start{0};
+        std::atomic<uint64_t> duration{0};
+        std::atomic<uint32_t> depth{0};
+    };
+
+    struct thread_buffer {
+        std::unique_ptr<profile_slot[]> slots = std::unique_ptr<profile_slot[]>(new profile_slot[PROFILER_RING_SIZE]);
+        // total number of zones written, only the owning thread increments it
+        std::atomic<uint64_t> written{0};
+        uint32_t id = 0;
+        std::string name;
+    };
+
+    std::atomic<bool> enabled{true};
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    std::mutex buffersMutex;
+    // the buffers outlive their threads so zones of finished jobs still show up in an export
+    std::vector<std::shared_ptr<thread_buffer>> buffers;
+
+    thread_local std::shared_ptr<thread_buffer> localBuffer;
+    thread_local uint32_t localDepth = 0;
+
+    thread_buffer &getLocalBuffer() {
+        if (!localBuffer) {
+            MEMORY_SCOPE(MEMORY_PROFILER);
+            localBuffer = std::make_shared<thread_buffer>();
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            localBuffer->id = static_cast<uint32_t>(buffers.size());
+            localBuffer->name = "Thread " + std::to_string(localBuffer->id);
+            buffers.push_back(localBuffer);
+        }
+        return *localBuffer;
+    }
+
+    // copies zone index of the ring, false when it was overwritten or is being overwritten
+    bool readSlot(const thread_buffer &buffer, uint64_t index, profile_event &event) {
+        const profile_slot &slot = buffer.slots[index % PROFILER_RING_SIZE];
+        uint64_t expected = 2 * index + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != expected)
+            return false;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.start = slot.start.load(std::memory_order_relaxed);
+        event.duration = slot.duration.load(std::memory_order_relaxed);
+        event.depth = slot.depth.load(std::memory_order_relaxed);
+        // the fields are read before the sequence is checked again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == expected;
+    }
+
+    // copies the zones still in the ring, entries the owner overwrote during the copy are dropped
+    void snapshot(const thread_buffer &buffer, uint64_t since, std::vector<profile_event> &events) {
+        uint64_t end = buffer.written.load(std::memory_order_acquire);
+        uint64_t begin = end > PROFILER_RING_SIZE ? end - PROFILER_RING_SIZE : 0;
+
+        // zones are written when they close so their end times only grow, the recent ones are found from the back
+        if (since > 0) {
+            uint64_t first = end;
+            profile_event previous;
+            while (first > begin) {
+                if (!readSlot(buffer, first - 1, previous) || previous.start + previous.duration < since)
+                    break;
+                first--;
+            }
+            begin = first;
+        }
+
+        events.clear();
+        events.reserve(end - begin);
+        profile_event event;
+        for (uint64_t i = begin; i < end; i++) {
+            if (readSlot(buffer, i, event))
+                events.push_back(event);
+        }
+    }
+
+    void writeEscaped(std::ofstream &file, const std::string &text) {
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                file << '\\';
+            file << c;
+        }
+    }
+}
+
+void profiler::setEnabled(bool value) {
+    enabled = value;
+}
+
+bool profiler::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t profiler::now() {
+    return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void profiler::setThreadName(const std::string &name) {
+    thread_buffer &buffer = getLocalBuffer();
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffer.name = name;
+}
+
+void profiler::record(const char *name, uint64_t start, uint64_t end, uint32_t depth) {
+    thread_buffer &buffer = getLocalBuffer();
+    uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    profile_slot &slot = buffer.slots[index % PROFILER_RING_SIZE];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    // readers seeing any of the new fields see the odd sequence too
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(end - start, std::memory_order_relaxed);
+    slot.depth.store(depth, std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void profiler::getThreadEvents(uint64_t since, std::vector<profile_event> &events) {
+    snapshot(getLocalBuffer(), since, events);
+}
+
+bool profiler::exportChromeTrace(const std::string &path) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        std::cout << "ERROR::PROFILER::FILE_NOT_WRITTEN: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<std::shared_ptr<thread_buffer>> threads;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        threads = buffers;
+    }
+
+    // microseconds with nanosecond precision, the default formatting switches to exponents
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    std::vector<profile_event> events;
+    for (const std::shared_ptr<thread_buffer> &buffer : threads) {
+        {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+                 << ",\"args\":{\"name\":\"";
+            writeEscaped(file, buffer->name);
+            file << "\"}}";
+            first = false;
+        }
+
+        // complete events in microseconds, the viewers nest them by time range
+        snapshot(*buffer, 0, events);
+        for (const profile_event &event : events) {
+            file << ",\n{\"name\":\"";
+            writeEscaped(file, event.name);
+            file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                 << ",\"ts\":" << static_cast<double>(event.start) / 1000.0
+                 << ",\"dur\":" << static_cast<double>(event.duration) / 1000.0
+                 << ",\"args\":{\"depth\":" << event.depth << "}}";
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+profile_scope::profile_scope(const char *name) : name(enabled.load(std::memory_order_relaxed) ? name : nullptr) {
+    if (this->name) {
+        start = profiler::now();
+        localDepth++;
+    }
+}
+
+profile_scope::~profile_scope() {
+    close();
+}
+
+void profile_scope::close() {
+    if (name) {
+        localDepth--;
+        profiler::record(name, start, profiler::now(), localDepth);
+        name = nullptr;
+    }
+}
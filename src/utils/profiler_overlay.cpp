@@ -0,0 +1,178 @@
+#include "VoxelEngine/utils/profiler_overlay.h"
+#include "VoxelEngine/utils/frame_arena.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // phases of the same name within a frame are summed
+    void addPhase(phase_time *phases, int &count, const char *name, float milliseconds) {
+        for (int i = 0; i < count; i++) {
+            if (phases[i].name == name || std::strcmp(phases[i].name, name) == 0) {
+                phases[i].milliseconds += milliseconds;
+                return;
+            }
+        }
+        if (count < OVERLAY_MAX_PHASES)
+            phases[count++] = {name, milliseconds};
+    }
+}
+
+profiler_overlay::profiler_overlay() : history(OVERLAY_HISTORY), editLatencies(OVERLAY_EDIT_HISTORY) {
+}
+
+void profiler_overlay::addEditLatency(float milliseconds) {
+    editLatencies[editNext] = milliseconds;
+    editNext = (editNext + 1) % editLatencies.size();
+    editCount = std::min(editCount + 1, editLatencies.size());
+}
+
+void profiler_overlay::addFrame(float frameTime, const std::vector<profile_event> &cpuEvents,
+                                const std::vector<phase_time> &gpuPhases) {
+    frame_breakdown frame;
+    frame.frameTime = frameTime;
+    for (const profile_event &event : cpuEvents) {
+        if (event.depth == 1)
+            addPhase(frame.cpu, frame.cpuCount, event.name, static_cast<float>(event.duration) / 1000000.0f);
+    }
+    for (const phase_time &phase : gpuPhases)
+        addPhase(frame.gpu, frame.gpuCount, phase.name, phase.milliseconds);
+
+    bool spike = false;
+    if (captureSpikes && !frozen && count >= OVERLAY_HISTORY / 4) {
+        getFrames(ordered);
+        float median = getPercentile(ordered, 0.5f);
+        spike = frameTime > median * spikeFactor;
+    }
+
+    history[next] = frame;
+    next = (next + 1) % history.size();
+    count = std::min(count + 1, history.size());
+
+    if (spike) {
+        frozen = true;
+        getFrames(frozenFrames);
+    }
+}
+
+bool profiler_overlay::isFrozen() const {
+    return frozen;
+}
+
+void profiler_overlay::getFrames(std::vector<frame_breakdown> &frames) const {
+    frames.clear();
+    size_t first = (next + history.size() - count) % history.size();
+    for (size_t i = 0; i < count; i++)
+        frames.push_back(history[(first + i) % history.size()]);
+}
+
+float profiler_overlay::getPercentile(const std::vector<frame_breakdown> &frames, float percentile) {
+    if (frames.empty())
+        return 0.0f;
+    scratch.clear();
+    for (const frame_breakdown &frame : frames)
+        scratch.push_back(frame.frameTime);
+    size_t rank = std::min(scratch.size() - 1, static_cast<size_t>(percentile * static_cast<float>(scratch.size())));
+    std::nth_element(scratch.begin(), scratch.begin() + rank, scratch.end());
+    return scratch[rank];
+}
+
+ImU32 profiler_overlay::getPhaseColor(const char *name) {
+    unsigned int hash = 2166136261u;
+    for (const char *c = name; *c; c++)
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+    return ImColor::HSV(static_cast<float>(hash % 360u) / 360.0f, 0.65f, 0.9f);
+}
+
+void profiler_overlay::drawPhaseGraph(const char *label, const std::vector<frame_breakdown> &frames, bool gpu) const {
+    ImGui::TextUnformatted(label);
+    ImVec2 size(ImGui::GetContentRegionAvail().x, 70.0f);
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), IM_COL32(0, 0, 0, 90));
+
+    float barWidth = size.x / static_cast<float>(OVERLAY_HISTORY);
+    float scale = size.y / graphMilliseconds;
+    for (size_t i = 0; i < frames.size(); i++) {
+        const frame_breakdown &frame = frames[i];
+        const phase_time *phases = gpu ? frame.gpu : frame.cpu;
+        int phaseCount = gpu ? frame.gpuCount : frame.cpuCount;
+
+        float x = origin.x + static_cast<float>(i) * barWidth;
+        float y = origin.y + size.y;
+        for (int p = 0; p < phaseCount && y > origin.y; p++) {
+            float top = std::max(origin.y, y - phases[p].milliseconds * scale);
+            drawList->AddRectFilled(ImVec2(x, top), ImVec2(x + barWidth, y), getPhaseColor(phases[p].name));
+            y = top;
+        }
+    }
+
+    // 60 fps budget
+    float budget = origin.y + size.y - 16.6f * scale;
+    if (budget > origin.y)
+        drawList->AddLine(ImVec2(origin.x, budget), ImVec2(origin.x + size.x, budget), IM_COL32(255, 255, 255, 120));
+
+    ImGui::InvisibleButton(label, size);
+    if (ImGui::IsItemHovered() && !frames.empty()) {
+        size_t index = static_cast<size_t>((ImGui::GetIO().MousePos.x - origin.x) / barWidth);
+        if (index < frames.size()) {
+            const frame_breakdown &frame = frames[index];
+            const phase_time *phases = gpu ? frame.gpu : frame.cpu;
+            int phaseCount = gpu ? frame.gpuCount : frame.cpuCount;
+            ImGui::BeginTooltip();
+            ImGui::Text("Frame %.2f ms", frame.frameTime);
+            for (int p = 0; p < phaseCount; p++)
+                ImGui::TextColored(ImColor(getPhaseColor(phases[p].name)), "%s %.3f ms", phases[p].name,
+                                   phases[p].milliseconds);
+            ImGui::EndTooltip();
+        }
+    }
+}
+
+void profiler_overlay::draw() {
+    if (!frozen)
+        getFrames(ordered);
+    const std::vector<frame_breakdown> &frames = frozen ? frozenFrames : ordered;
+
+    ImGui::Text("p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", getPercentile(frames, 0.5f),
+                getPercentile(frames, 0.95f), getPercentile(frames, 0.99f), getPercentile(frames, 1.0f));
+
+    ImGui::Checkbox("Capture spikes", &captureSpikes);
+    if (frozen) {
+        ImGui::SameLine();
+        if (ImGui::Button("Resume"))
+            frozen = false;
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "spike captured");
+    }
+
+    if (editCount > 0) {
+        float last = editLatencies[(editNext + editLatencies.size() - 1) % editLatencies.size()];
+        scratch.assign(editLatencies.begin(), editLatencies.begin() + editCount);
+        std::sort(scratch.begin(), scratch.end());
+        ImGui::Text("Edit latency %.2f ms  p50 %.2f  max %.2f ms", last, scratch[scratch.size() / 2], scratch.back());
+    }
+
+    drawPhaseGraph("CPU", frames, false);
+    drawPhaseGraph("GPU", frames, true);
+
+    // legend from the newest frame
+    if (!frames.empty()) {
+        const frame_breakdown &last = frames.back();
+        for (int p = 0; p < last.cpuCount; p++)
+            ImGui::TextColored(ImColor(getPhaseColor(last.cpu[p].name)), "%-16s %6.3f ms", last.cpu[p].name,
+                               last.cpu[p].milliseconds);
+        for (int p = 0; p < last.gpuCount; p++)
+            ImGui::TextColored(ImColor(getPhaseColor(last.gpu[p].name)), "GPU %-12s %6.3f ms", last.gpu[p].name,
+                               last.gpu[p].milliseconds);
+    }
+
+    // 1 ms buckets over twice the graph range, the last bucket also holds everything slower
+    const int bucketCount = 2 * static_cast<int>(graphMilliseconds);
+    arena_vector<float> buckets(std::max(1, bucketCount), 0.0f, frame_arena::allocator<float>());
+    for (const frame_breakdown &frame : frames) {
+        int bucket = std::min(static_cast<int>(buckets.size()) - 1, static_cast<int>(frame.frameTime));
+        buckets[std::max(0, bucket)] += 1.0f;
+    }
+    ImGui::PlotHistogram("##FrameHistogram", buckets.data(), static_cast<int>(buckets.size()), 0,
+                         "frame time histogram (1 ms)", 0.0f, FLT_MAX, ImVec2(ImGui::GetContentRegionAvail().x, 60.0f));
+}
@@ -0,0 +1,147 @@
+#include "VoxelEngine/utils/program_cache.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace {
+    typedef void (APIENTRYP PFN_GetProgramBinary)(GLuint, GLsizei, GLsizei *, GLenum *, void *);
+    typedef void (APIENTRYP PFN_ProgramBinary)(GLuint, GLenum, const void *, GLsizei);
+    typedef void (APIENTRYP PFN_ProgramParameteri)(GLuint, GLenum, GLint);
+
+    PFN_GetProgramBinary getProgramBinary = nullptr;
+    PFN_ProgramBinary programBinary = nullptr;
+    PFN_ProgramParameteri programParameteri = nullptr;
+
+    std::string cacheDirectory;
+    std::string driver;
+    bool enabled = false;
+
+    const char CACHE_MAGIC[4] = {'V', 'P', 'R', 'G'};
+
+    // FNV-1a, stable across runs and platforms unlike std::hash
+    uint64_t hashBytes(uint64_t hash, const std::string &bytes) {
+        for (unsigned char c : bytes) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        // separator so "ab" + "c" and "a" + "bc" differ
+        hash ^= 0xff;
+        return hash * 1099511628211ull;
+    }
+
+    std::string getCachePath(uint64_t key) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return cacheDirectory + "/" + name;
+    }
+
+    std::string getString(GLenum name) {
+        const GLubyte *value = glGetString(name);
+        return value ? reinterpret_cast<const char *>(value) : "";
+    }
+}
+
+void program_cache::init(GLADloadproc load, const std::string &directory) {
+    getProgramBinary = reinterpret_cast<PFN_GetProgramBinary>(load("glGetProgramBinary"));
+    programBinary = reinterpret_cast<PFN_ProgramBinary>(load("glProgramBinary"));
+    programParameteri = reinterpret_cast<PFN_ProgramParameteri>(load("glProgramParameteri"));
+
+    GLint formats = 0;
+    if (getProgramBinary && programBinary && programParameteri)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    enabled = formats > 0;
+    if (!enabled) {
+        std::cout << "Program binaries are not supported, shaders are compiled on every launch" << std::endl;
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cout << "ERROR::PROGRAM_CACHE::DIRECTORY_NOT_CREATED: " << directory << std::endl;
+        enabled = false;
+        return;
+    }
+    cacheDirectory = directory;
+    driver = getString(GL_VENDOR) + "\n" + getString(GL_RENDERER) + "\n" + getString(GL_VERSION);
+}
+
+bool program_cache::isEnabled() {
+    return enabled;
+}
+
+uint64_t program_cache::makeKey(const std::string &vertexSource, const std::string &fragmentSource) {
+    uint64_t hash = 14695981039346656037ull;
+    hash = hashBytes(hash, vertexSource);
+    hash = hashBytes(hash, fragmentSource);
+    return hashBytes(hash, driver);
+}
+
+void program_cache::prepare(GLuint program) {
+    if (enabled)
+        programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+bool program_cache::load(GLuint program, uint64_t key) {
+    if (!enabled)
+        return false;
+
+    std::ifstream file(getCachePath(key), std::ios::binary);
+    if (!file)
+        return false;
+
+    char magic[4];
+    uint64_t storedKey = 0;
+    uint32_t format = 0, length = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char *>(&storedKey), sizeof(storedKey));
+    file.read(reinterpret_cast<char *>(&format), sizeof(format));
+    file.read(reinterpret_cast<char *>(&length), sizeof(length));
+    if (!file || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 || storedKey != key || length == 0)
+        return false;
+
+    std::vector<char> binary(length);
+    if (!file.read(binary.data(), length))
+        return false;
+
+    // the driver may still refuse a binary it produced, e.g. after an update that kept the version string
+    programBinary(program, format, binary.data(), static_cast<GLsizei>(length));
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success != 0;
+}
+
+void program_cache::store(GLuint program, uint64_t key) {
+    if (!enabled)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    getProgramBinary(program, length, nullptr, &format, binary.data());
+
+    std::ofstream file(getCachePath(key), std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cout << "ERROR::PROGRAM_CACHE::FILE_NOT_WRITTEN: " << getCachePath(key) << std::endl;
+        return;
+    }
+    uint32_t binaryFormat = format, binaryLength = static_cast<uint32_t>(length);
+    file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    file.write(reinterpret_cast<const char *>(&key), sizeof(key));
+    file.write(reinterpret_cast<const char *>(&binaryFormat), sizeof(binaryFormat));
+    file.write(reinterpret_cast<const char *>(&binaryLength), sizeof(binaryLength));
+    file.write(binary.data(), length);
+}
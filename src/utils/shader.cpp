@@ -1,39 +1,103 @@
 #include "VoxelEngine/utils/shader.h"
+#include "VoxelEngine/utils/program_cache.h"
+#include "VoxelEngine/utils/shader_preprocessor.h"
+#include "VoxelEngine/utils/uniform_buffer.h"
+#include <algorithm>
+#include <vector>
 
 unsigned int ID;
 
-shader::shader(const GLchar *vertexPath, const GLchar *fragmentPath) {
-    // 1. retrieve the vertex/fragment source code from filePath
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    // ensure ifstream objects can throw exceptions:
-    vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    try
-    {
-        // open files
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
-        // read file's buffer contents into streams
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        // close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
-        // convert stream into string
-        vertexCode   = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-    }
-    catch (std::ifstream::failure& e)
+bool shader_source::load(const std::string &vertexPath, const std::string &fragmentPath,
+                         const std::vector<std::string> &defines)
+{
+    this->vertexPath = vertexPath;
+    this->fragmentPath = fragmentPath;
+    this->defines = defines;
+
+    std::vector<std::string> vertexFiles, fragmentFiles;
+    bool vertexRead = preprocessShader(vertexPath, defines, vertex, &vertexFiles);
+    bool fragmentRead = preprocessShader(fragmentPath, defines, fragment, &fragmentFiles);
+
+    files = vertexFiles;
+    for (const std::string &file : fragmentFiles)
+        if (std::find(files.begin(), files.end(), file) == files.end())
+            files.push_back(file);
+    return vertexRead && fragmentRead;
+}
+
+shader::shader(const GLchar *vertexPath, const GLchar *fragmentPath)
+{
+    // 1. retrieve the vertex/fragment source code from filePath, with their includes resolved
+    shader_source source;
+    source.load(vertexPath, fragmentPath);
+    // 2. build the program, or reuse the binary a previous launch linked from the same sources
+    bool linked;
+    ID = createProgram(source.vertex, source.fragment, linked);
+    setOrigin(source);
+    reflect();
+}
+
+shader::shader(const shader_source &source)
+{
+    bool linked;
+    ID = createProgram(source.vertex, source.fragment, linked);
+    setOrigin(source);
+    reflect();
+}
+
+shader::~shader()
+{
+    glDeleteProgram(ID);
+}
+
+void shader::setOrigin(const shader_source &source)
+{
+    vertexPath = source.vertexPath;
+    fragmentPath = source.fragmentPath;
+    defines = source.defines;
+    files = source.files;
+}
+
+bool shader::reload()
+{
+    if (vertexPath.empty())
+        return false;
+
+    shader_source source;
+    if (!source.load(vertexPath, fragmentPath, defines))
+        return false;
+    files = source.files;
+
+    bool linked;
+    unsigned int program = createProgram(source.vertex, source.fragment, linked);
+    if (!linked)
     {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+        std::cout << "Reload of " << vertexPath << " failed, the previous program is kept" << std::endl;
+        glDeleteProgram(program);
+        return false;
     }
+
+    glDeleteProgram(ID);
+    ID = program;
+    reflect();
+    return true;
+}
+
+const std::vector<std::string> &shader::getFiles() const
+{
+    return files;
+}
+
+unsigned int shader::createProgram(const std::string &vertexCode, const std::string &fragmentCode, bool &linked)
+{
+    unsigned int program = glCreateProgram();
+    uint64_t key = program_cache::makeKey(vertexCode, fragmentCode);
+    linked = program_cache::load(program, key);
+    if (linked)
+        return program;
+
     const char* vShaderCode = vertexCode.c_str();
     const char * fShaderCode = fragmentCode.c_str();
-    // 2. compile shaders
     unsigned int vertex, fragment;
     // vertex shader
     vertex = glCreateShader(GL_VERTEX_SHADER);
@@ -46,14 +110,19 @@ shader::shader(const GLchar *vertexPath, const GLchar *fragmentPath) {
     glCompileShader(fragment);
     checkCompileErrors(fragment, "FRAGMENT");
     // shader Program
-    ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
-    checkCompileErrors(ID, "PROGRAM");
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    program_cache::prepare(program);
+    glLinkProgram(program);
+    linked = checkCompileErrors(program, "PROGRAM");
+    if (linked)
+        program_cache::store(program, key);
     // delete the shaders as they're linked into our program now and no longer necessary
+    glDetachShader(program, vertex);
+    glDetachShader(program, fragment);
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+    return program;
 }
 
 // activate the shader
@@ -62,65 +131,160 @@ void shader::use()
 {
     glUseProgram(ID);
 }
+// ------------------------------------------------------------------------
+void shader::reflect()
+{
+    uniforms.clear();
+    attributes.clear();
+
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<GLchar> name(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+        std::string uniformName(name.data(), length);
+        // members of uniform blocks have no location
+        GLint location = glGetUniformLocation(ID, uniformName.c_str());
+        if (location < 0)
+            continue;
+        uniforms[uniformName] = location;
+        // arrays are reported as "name[0]", also accept the plain name like glGetUniformLocation does
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+            uniforms[uniformName.substr(0, uniformName.size() - 3)] = location;
+    }
+
+    glGetProgramiv(ID, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(ID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    name.assign(std::max(maxLength, 1), 0);
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveAttrib(ID, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+        std::string attributeName(name.data(), length);
+        attributes[attributeName] = glGetAttribLocation(ID, attributeName.c_str());
+    }
+
+    GLuint frameBlock = glGetUniformBlockIndex(ID, "FrameData");
+    if (frameBlock != GL_INVALID_INDEX)
+        glUniformBlockBinding(ID, frameBlock, FRAME_DATA_BINDING);
+}
+
+GLint shader::getUniformLocation(const std::string &name) const
+{
+    auto it = uniforms.find(name);
+    return it != uniforms.end() ? it->second : -1;
+}
+
+GLint shader::getAttributeLocation(const std::string &name) const
+{
+    auto it = attributes.find(name);
+    return it != attributes.end() ? it->second : -1;
+}
+
 // utility uniform functions
 // ------------------------------------------------------------------------
 void shader::setBool(const std::string &name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    glUniform1i(getUniformLocation(name), (int)value);
 }
 // ------------------------------------------------------------------------
 void shader::setInt(const std::string &name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1i(getUniformLocation(name), value);
 }
 // ------------------------------------------------------------------------
 void shader::setFloat(const std::string &name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1f(getUniformLocation(name), value);
 }
 void shader::setVec2(const std::string &name, const glm::vec2 &value) const
 {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform2fv(getUniformLocation(name), 1, &value[0]);
 }
 void shader::setVec2(const std::string &name, float x, float y) const
 {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+    glUniform2f(getUniformLocation(name), x, y);
 }
 // ------------------------------------------------------------------------
 void shader::setVec3(const std::string &name, const glm::vec3 &value) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform3fv(getUniformLocation(name), 1, &value[0]);
 }
 void shader::setVec3(const std::string &name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    glUniform3f(getUniformLocation(name), x, y, z);
 }
 // ------------------------------------------------------------------------
 void shader::setVec4(const std::string &name, const glm::vec4 &value) const
 {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform4fv(getUniformLocation(name), 1, &value[0]);
 }
 void shader::setVec4(const std::string &name, float x, float y, float z, float w) const
 {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+    glUniform4f(getUniformLocation(name), x, y, z, w);
 }
 // ------------------------------------------------------------------------
 void shader::setMat2(const std::string &name, const glm::mat2 &mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 // ------------------------------------------------------------------------
 void shader::setMat3(const std::string &name, const glm::mat3 &mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 // ------------------------------------------------------------------------
 void shader::setMat4(const std::string &name, const glm::mat4 &mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
+}
+
+// ------------------------------------------------------------------------
+void shader::set(uniform<bool> handle, bool value) const
+{
+    glUniform1i(handle.location, (int)value);
+}
+void shader::set(uniform<int> handle, int value) const
+{
+    glUniform1i(handle.location, value);
+}
+void shader::set(uniform<float> handle, float value) const
+{
+    glUniform1f(handle.location, value);
+}
+void shader::set(uniform<glm::vec2> handle, const glm::vec2 &value) const
+{
+    glUniform2fv(handle.location, 1, &value[0]);
+}
+void shader::set(uniform<glm::vec3> handle, const glm::vec3 &value) const
+{
+    glUniform3fv(handle.location, 1, &value[0]);
+}
+void shader::set(uniform<glm::vec4> handle, const glm::vec4 &value) const
+{
+    glUniform4fv(handle.location, 1, &value[0]);
+}
+void shader::set(uniform<glm::mat2> handle, const glm::mat2 &value) const
+{
+    glUniformMatrix2fv(handle.location, 1, GL_FALSE, &value[0][0]);
+}
+void shader::set(uniform<glm::mat3> handle, const glm::mat3 &value) const
+{
+    glUniformMatrix3fv(handle.location, 1, GL_FALSE, &value[0][0]);
+}
+void shader::set(uniform<glm::mat4> handle, const glm::mat4 &value) const
+{
+    glUniformMatrix4fv(handle.location, 1, GL_FALSE, &value[0][0]);
 }
 
-void shader::checkCompileErrors(unsigned int shader, std::string type)
+bool shader::checkCompileErrors(unsigned int shader, std::string type)
 {
     int success;
     char infoLog[1024];
@@ -142,4 +306,5 @@ void shader::checkCompileErrors(unsigned int shader, std::string type)
             std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
         }
     }
+    return success != 0;
 }
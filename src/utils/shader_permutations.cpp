@@ -0,0 +1,107 @@
+#include "VoxelEngine/utils/shader_permutations.h"
+#include <algorithm>
+
+shader_permutations::shader_permutations(thread_pool &pool, std::string vertexPath, std::string fragmentPath,
+                                         std::vector<std::string> features, std::function<void(shader &)> setup)
+        : pool(pool), vertexPath(std::move(vertexPath)), fragmentPath(std::move(fragmentPath)),
+          features(std::move(features)), setup(std::move(setup)) {
+}
+
+std::vector<std::string> shader_permutations::getDefines(uint32_t featureMask) const {
+    std::vector<std::string> defines;
+    for (size_t i = 0; i < features.size(); i++) {
+        if (featureMask & (1u << i))
+            defines.push_back(features[i]);
+    }
+    return defines;
+}
+
+void shader_permutations::request(uint32_t featureMask) {
+    if (compiled.count(featureMask) != 0 || pending.count(featureMask) != 0)
+        return;
+
+    std::shared_ptr<pending_source> job = std::make_shared<pending_source>();
+    pending[featureMask] = job;
+    std::vector<std::string> defines = getDefines(featureMask);
+    std::string vertex = vertexPath, fragment = fragmentPath;
+    pool.enqueue([job, defines, vertex, fragment]() {
+        job->source.load(vertex, fragment, defines);
+        job->done = true;
+    });
+}
+
+void shader_permutations::update() {
+    int budget = compileBudget;
+    for (auto it = pending.begin(); it != pending.end() && budget > 0;) {
+        if (!it->second->done) {
+            ++it;
+            continue;
+        }
+        build(it->first, it->second->source);
+        it = pending.erase(it);
+        budget--;
+    }
+}
+
+shader &shader_permutations::get(uint32_t featureMask) {
+    auto it = compiled.find(featureMask);
+    if (it != compiled.end())
+        return *it->second;
+
+    shader_source source;
+    auto job = pending.find(featureMask);
+    if (job != pending.end() && job->second->done) {
+        source = std::move(job->second->source);
+    } else {
+        // a job still running is simply left behind, its result is dropped with the shared state
+        source.load(vertexPath, fragmentPath, getDefines(featureMask));
+    }
+    pending.erase(featureMask);
+    return build(featureMask, source);
+}
+
+bool shader_permutations::isReady(uint32_t featureMask) const {
+    return compiled.count(featureMask) != 0;
+}
+
+size_t shader_permutations::getCompiledCount() const {
+    return compiled.size();
+}
+
+void shader_permutations::watch(file_watcher &watcher) {
+    shader_source source;
+    source.load(vertexPath, fragmentPath);
+    this->watcher = &watcher;
+    watchId = watcher.watch(source.files, [this]() { reload(); });
+}
+
+void shader_permutations::reload() {
+    // sources read before the change are outdated
+    pending.clear();
+    for (auto &entry : compiled) {
+        if (entry.second->reload() && setup) {
+            entry.second->use();
+            setup(*entry.second);
+        }
+    }
+    if (watcher == nullptr || compiled.empty())
+        return;
+
+    std::vector<std::string> files;
+    for (const auto &entry : compiled) {
+        for (const std::string &file : entry.second->getFiles())
+            if (std::find(files.begin(), files.end(), file) == files.end())
+                files.push_back(file);
+    }
+    watcher->setPaths(watchId, files);
+}
+
+shader &shader_permutations::build(uint32_t featureMask, const shader_source &source) {
+    std::unique_ptr<shader> &program = compiled[featureMask];
+    program.reset(new shader(source));
+    if (setup) {
+        program->use();
+        setup(*program);
+    }
+    return *program;
+}
@@ -0,0 +1,90 @@
+#include "VoxelEngine/utils/shader_preprocessor.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    struct context {
+        std::vector<std::string> files;
+        std::vector<std::string> stack;
+        const std::vector<std::string> &defines;
+    };
+
+    bool startsWithDirective(const std::string &line, const char *directive, size_t &end) {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line.compare(start, std::char_traits<char>::length(directive), directive) != 0)
+            return false;
+        end = start + std::char_traits<char>::length(directive);
+        return true;
+    }
+
+    std::string lineDirective(int line, size_t source) {
+        return "#line " + std::to_string(line) + " " + std::to_string(source) + "\n";
+    }
+
+    bool expand(const std::filesystem::path &path, context &ctx, std::string &output) {
+        std::string name = path.lexically_normal().generic_string();
+        if (std::find(ctx.stack.begin(), ctx.stack.end(), name) != ctx.stack.end()) {
+            std::cout << "ERROR::SHADER::CIRCULAR_INCLUDE: " << name << std::endl;
+            return false;
+        }
+        // every file is only included once, like with #pragma once
+        if (std::find(ctx.files.begin(), ctx.files.end(), name) != ctx.files.end())
+            return true;
+
+        std::ifstream file(path);
+        if (!file) {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << name << std::endl;
+            return false;
+        }
+        size_t source = ctx.files.size();
+        ctx.files.push_back(name);
+        // the top file starts with #version, nothing may come before it
+        if (!ctx.stack.empty())
+            output += lineDirective(1, source);
+        ctx.stack.push_back(name);
+
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            lineNumber++;
+            size_t end;
+            if (startsWithDirective(line, "#include", end)) {
+                size_t open = line.find('"', end);
+                size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+                if (close == std::string::npos) {
+                    std::cout << "ERROR::SHADER::INVALID_INCLUDE: " << name << ":" << lineNumber << std::endl;
+                    return false;
+                }
+                std::filesystem::path included = path.parent_path() / line.substr(open + 1, close - open - 1);
+                if (!expand(included, ctx, output))
+                    return false;
+                output += lineDirective(lineNumber + 1, source);
+            } else if (startsWithDirective(line, "#version", end)) {
+                output += line + "\n";
+                if (ctx.stack.size() == 1) {
+                    for (const std::string &define : ctx.defines)
+                        output += "#define " + define + "\n";
+                }
+                output += lineDirective(lineNumber + 1, source);
+            } else {
+                output += line + "\n";
+            }
+        }
+
+        ctx.stack.pop_back();
+        return true;
+    }
+}
+
+bool preprocessShader(const std::string &path, const std::vector<std::string> &defines, std::string &output,
+                      std::vector<std::string> *files) {
+    context ctx{{}, {}, defines};
+    output.clear();
+    bool success = expand(std::filesystem::path(path), ctx, output);
+    if (files)
+        *files = ctx.files;
+    return success;
+}
@@ -0,0 +1,98 @@
+#include "VoxelEngine/utils/simulation_loop.h"
+#include "VoxelEngine/utils/profiler.h"
+#include <algorithm>
+
+simulation_loop::simulation_loop(float stepSeconds, std::function<void(float)> step)
+        : stepDuration(std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(stepSeconds))),
+          stepSeconds(stepSeconds), step(std::move(step)),
+          nextStep((clock::now() + stepDuration).time_since_epoch().count()) {
+}
+
+simulation_loop::~simulation_loop() {
+    setThreaded(false);
+}
+
+simulation_loop::clock::time_point simulation_loop::runDueSteps(clock::time_point now) {
+    clock::time_point next(clock::duration(nextStep.load()));
+    int steps = 0;
+    while (next <= now && steps < maxCatchUpSteps) {
+        PROFILE_SCOPE("Simulation step");
+        uint64_t start = profiler::now();
+        {
+            // the step and its time change together for getAlpha called under the mutex
+            std::lock_guard<std::mutex> lock(mutex);
+            step(stepSeconds);
+            next += stepDuration;
+            nextStep = next.time_since_epoch().count();
+        }
+        stepMilliseconds = static_cast<float>(profiler::now() - start) / 1000000.0f;
+        stepCount++;
+        steps++;
+    }
+    if (next <= now)
+        next = now + stepDuration;
+    nextStep = next.time_since_epoch().count();
+    return next;
+}
+
+void simulation_loop::update() {
+    if (!thread.joinable())
+        runDueSteps(clock::now());
+}
+
+void simulation_loop::setThreaded(bool threaded) {
+    if (threaded == thread.joinable())
+        return;
+
+    if (threaded) {
+        stopping = false;
+        thread = std::thread([this] {
+            profiler::setThreadName("Simulation");
+            threadLoop();
+        });
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(threadMutex);
+        stopping = true;
+    }
+    threadCondition.notify_all();
+    thread.join();
+}
+
+bool simulation_loop::isThreaded() const {
+    return thread.joinable();
+}
+
+void simulation_loop::threadLoop() {
+    std::unique_lock<std::mutex> lock(threadMutex);
+    while (!stopping) {
+        lock.unlock();
+        clock::time_point next = runDueSteps(clock::now());
+        lock.lock();
+        threadCondition.wait_until(lock, next, [this] { return stopping; });
+    }
+}
+
+std::mutex &simulation_loop::getMutex() {
+    return mutex;
+}
+
+float simulation_loop::getAlpha() const {
+    clock::time_point last = clock::time_point(clock::duration(nextStep.load())) - stepDuration;
+    float elapsed = std::chrono::duration<float>(clock::now() - last).count();
+    return std::min(std::max(elapsed / stepSeconds, 0.0f), 1.0f);
+}
+
+float simulation_loop::getStepSeconds() const {
+    return stepSeconds;
+}
+
+uint64_t simulation_loop::getStepCount() const {
+    return stepCount.load();
+}
+
+float simulation_loop::getStepMilliseconds() const {
+    return stepMilliseconds.load();
+}
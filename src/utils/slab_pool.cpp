@@ -0,0 +1,165 @@
+#include "VoxelEngine/utils/slab_pool.h"
+#include "VoxelEngine/utils/memory_tracker.h"
+#include <algorithm>
+#include <mutex>
+
+namespace {
+    // free blocks are linked through their first bytes
+    struct free_block {
+        free_block *next;
+    };
+
+    struct global_class {
+        std::mutex mutex;
+        free_block *head = nullptr;
+        size_t count = 0;
+        size_t reserved = 0;
+    };
+
+    struct global_pool {
+        global_class classes[SLAB_CLASS_COUNT];
+    };
+
+    // never destroyed, the caches of exiting threads flush into it until the very end of the program
+    global_pool &getGlobalPool() {
+        static global_pool *pool = new global_pool();
+        return *pool;
+    }
+
+    size_t getBlockSize(int sizeClass) {
+        return SLAB_MIN_BLOCK << sizeClass;
+    }
+
+    size_t getCacheLimit(int sizeClass) {
+        return std::max<size_t>(2, SLAB_THREAD_CACHE_BYTES / getBlockSize(sizeClass));
+    }
+
+    // moves up to count blocks from the global pool to a list, carving a new slab when it is empty
+    free_block *takeBlocks(int sizeClass, size_t count, size_t &taken) {
+        global_class &pool = getGlobalPool().classes[sizeClass];
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (pool.head == nullptr) {
+            size_t blockSize = getBlockSize(sizeClass);
+            size_t slabSize = std::max(SLAB_SIZE, blockSize);
+            unsigned char *slab;
+            {
+                MEMORY_SCOPE(MEMORY_POOLS);
+                slab = new unsigned char[slabSize];
+            }
+            for (size_t offset = 0; offset + blockSize <= slabSize; offset += blockSize) {
+                free_block *block = reinterpret_cast<free_block *>(slab + offset);
+                block->next = pool.head;
+                pool.head = block;
+                pool.count++;
+            }
+            pool.reserved += slabSize;
+        }
+
+        free_block *first = pool.head;
+        free_block *last = nullptr;
+        taken = 0;
+        while (pool.head != nullptr && taken < count) {
+            last = pool.head;
+            pool.head = pool.head->next;
+            taken++;
+        }
+        last->next = nullptr;
+        pool.count -= taken;
+        return first;
+    }
+
+    void giveBlocks(int sizeClass, free_block *first, free_block *last, size_t count) {
+        global_class &pool = getGlobalPool().classes[sizeClass];
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        last->next = pool.head;
+        pool.head = first;
+        pool.count += count;
+    }
+
+    struct thread_cache {
+        free_block *heads[SLAB_CLASS_COUNT] = {};
+        size_t counts[SLAB_CLASS_COUNT] = {};
+
+        ~thread_cache() {
+            flush();
+        }
+
+        void flush() {
+            for (int sizeClass = 0; sizeClass < SLAB_CLASS_COUNT; sizeClass++)
+                release(sizeClass, counts[sizeClass]);
+        }
+
+        // gives the first count blocks of a class back to the global pool
+        void release(int sizeClass, size_t count) {
+            if (count == 0)
+                return;
+            free_block *first = heads[sizeClass];
+            free_block *last = first;
+            for (size_t i = 1; i < count; i++)
+                last = last->next;
+            heads[sizeClass] = last->next;
+            counts[sizeClass] -= count;
+            giveBlocks(sizeClass, first, last, count);
+        }
+    };
+
+    thread_local thread_cache cache;
+}
+
+int slab_pool::getSizeClass(size_t size) {
+    if (size > SLAB_MAX_BLOCK)
+        return -1;
+    int sizeClass = 0;
+    while (getBlockSize(sizeClass) < size)
+        sizeClass++;
+    return sizeClass;
+}
+
+void *slab_pool::allocate(size_t size) {
+    int sizeClass = getSizeClass(size);
+    if (sizeClass < 0)
+        return ::operator new(size);
+
+    if (cache.heads[sizeClass] == nullptr) {
+        size_t taken;
+        cache.heads[sizeClass] = takeBlocks(sizeClass, getCacheLimit(sizeClass) / 2, taken);
+        cache.counts[sizeClass] = taken;
+    }
+
+    free_block *block = cache.heads[sizeClass];
+    cache.heads[sizeClass] = block->next;
+    cache.counts[sizeClass]--;
+    return block;
+}
+
+void slab_pool::deallocate(void *pointer, size_t size) {
+    if (pointer == nullptr)
+        return;
+    int sizeClass = getSizeClass(size);
+    if (sizeClass < 0) {
+        ::operator delete(pointer);
+        return;
+    }
+
+    free_block *block = static_cast<free_block *>(pointer);
+    block->next = cache.heads[sizeClass];
+    cache.heads[sizeClass] = block;
+    cache.counts[sizeClass]++;
+    // threads that mostly free, like the GL thread releasing uploaded meshes, feed the workers through the pool
+    if (cache.counts[sizeClass] > getCacheLimit(sizeClass))
+        cache.release(sizeClass, cache.counts[sizeClass] / 2);
+}
+
+void slab_pool::flushThreadCache() {
+    cache.flush();
+}
+
+slab_class_stats slab_pool::getStats(int sizeClass) {
+    global_class &pool = getGlobalPool().classes[sizeClass];
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    slab_class_stats stats;
+    stats.blockSize = getBlockSize(sizeClass);
+    stats.reservedBytes = pool.reserved;
+    stats.pooledBytes = pool.count * stats.blockSize;
+    return stats;
+}
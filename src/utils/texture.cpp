@@ -1,4 +1,5 @@
 #include "VoxelEngine/utils/texture.h"
+#include "VoxelEngine/utils/memory_tracker.h"
 #include <iostream>
 
 // Constructor
@@ -25,6 +26,7 @@ texture::texture(const std::string &path, bool flip) {
 // Destructor
 texture::~texture() {
     glDeleteTextures(1, &textureID);
+    memory_tracker::releaseGPU(GPU_TEXTURE, textureID);
 }
 
 void texture::generateTexture(){
@@ -46,6 +48,9 @@ void texture::loadImage(const std::string &path, bool flip){
     {
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
+        // the mip chain adds a third, drivers usually pad RGB to 4 bytes per texel
+        memory_tracker::trackGPU(GPU_TEXTURE, textureID, MEMORY_TEXTURES,
+                                 static_cast<size_t>(width) * height * 4 * 4 / 3);
     }
     else
     {
@@ -74,6 +79,8 @@ void texture::generateUnicolorTexture(const glm::vec4 &color, int width, int hei
     // Generate the texture
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
     glGenerateMipmap(GL_TEXTURE_2D);
+    memory_tracker::trackGPU(GPU_TEXTURE, textureID, MEMORY_TEXTURES,
+                             static_cast<size_t>(width) * height * 4 * 4 / 3);
 
     // Set texture parameters
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
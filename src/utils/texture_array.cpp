@@ -0,0 +1,84 @@
+#include "VoxelEngine/utils/texture_array.h"
+#include "VoxelEngine/utils/memory_tracker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+GLenum getCompressedGLFormat(bc_format format) {
+    switch (format) {
+        case BC_FORMAT_BC1:
+            return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case BC_FORMAT_BC3:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case BC_FORMAT_BC7:
+            return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        default:
+            return GL_RGBA8;
+    }
+}
+
+bool isCompressedFormatSupported(bc_format format) {
+    if (format == BC_FORMAT_NONE)
+        return true;
+
+    const char *extension = format == BC_FORMAT_BC7 ? "GL_ARB_texture_compression_bptc"
+                                                    : "GL_EXT_texture_compression_s3tc";
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char *name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && std::strcmp(name, extension) == 0)
+            return true;
+    }
+    return false;
+}
+
+texture_array::texture_array(int width, int height, int layers, bc_format format)
+        : width(width), height(height), layers(layers), format(format) {
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+
+    // allocate the whole mip chain up front
+    int levels = 1 + static_cast<int>(std::floor(std::log2(std::max(width, height))));
+    size_t bytes = 0;
+    for (int level = 0; level < levels; level++) {
+        int levelWidth = std::max(1, width >> level), levelHeight = std::max(1, height >> level);
+        if (format == BC_FORMAT_NONE) {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, levelWidth, levelHeight, layers, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, nullptr);
+            bytes += static_cast<size_t>(levelWidth) * levelHeight * layers * 4;
+        } else {
+            GLsizei size = static_cast<GLsizei>(bcLevelSize(format, levelWidth, levelHeight) * layers);
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, getCompressedGLFormat(format), levelWidth, levelHeight,
+                                   layers, 0, size, nullptr);
+            bytes += static_cast<size_t>(size);
+        }
+    }
+    memory_tracker::trackGPU(GPU_TEXTURE, textureID, MEMORY_TEXTURES, bytes);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+}
+
+texture_array::~texture_array() {
+    glDeleteTextures(1, &textureID);
+    memory_tracker::releaseGPU(GPU_TEXTURE, textureID);
+}
+
+void texture_array::setLayer(int layer, const unsigned char *pixels) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
+
+void texture_array::generateMipmaps() {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
+
+void texture_array::bind(unsigned int unit) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+}
@@ -0,0 +1,209 @@
+#include "VoxelEngine/utils/texture_loader.h"
+#include "VoxelEngine/utils/frame_arena.h"
+#include "VoxelEngine/utils/memory_tracker.h"
+#include "VoxelEngine/utils/profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+texture_loader::texture_loader(thread_pool &pool) : pool(pool) {
+    glGenBuffers(1, &pbo);
+}
+
+texture_loader::~texture_loader() {
+    while (jobsInFlight.load() > 0)
+        std::this_thread::yield();
+    glDeleteBuffers(1, &pbo);
+    memory_tracker::releaseGPU(GPU_BUFFER, pbo);
+}
+
+void texture_loader::load(const std::string &path, texture &target, bool flip) {
+    std::shared_ptr<request> job = std::make_shared<request>();
+    job->path = path;
+    job->flip = flip;
+    job->target = GL_TEXTURE_2D;
+    job->textureID = target.textureID;
+    enqueue(job);
+}
+
+void texture_loader::load(const std::string &path, texture_array &target, int layer, bool flip) {
+    std::shared_ptr<request> job = std::make_shared<request>();
+    job->path = path;
+    job->flip = flip;
+    job->target = GL_TEXTURE_2D_ARRAY;
+    job->textureID = target.textureID;
+    job->layer = layer;
+    job->width = target.width;
+    job->height = target.height;
+    job->format = target.format;
+    enqueue(job);
+}
+
+void texture_loader::load(std::vector<unsigned char> pixels, texture_array &target, int layer) {
+    std::shared_ptr<request> job = std::make_shared<request>();
+    job->pixels = std::move(pixels);
+    job->target = GL_TEXTURE_2D_ARRAY;
+    job->textureID = target.textureID;
+    job->layer = layer;
+    job->width = target.width;
+    job->height = target.height;
+    job->format = target.format;
+    enqueue(job);
+}
+
+void texture_loader::enqueue(const std::shared_ptr<request> &job) {
+    jobsInFlight++;
+    pool.enqueue([this, job]() {
+        decode(*job);
+        if (!job->levels.empty()) {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completed.push_back(job);
+        }
+        jobsInFlight--;
+    });
+}
+
+namespace {
+    bool isCookedTexture(const std::string &path) {
+        return path.size() > 5 && path.compare(path.size() - 5, 5, ".vtex") == 0;
+    }
+}
+
+// runs on a worker
+void texture_loader::decode(request &job) {
+    PROFILE_SCOPE("Texture decode");
+    MEMORY_SCOPE(MEMORY_TEXTURES);
+    if (isCookedTexture(job.path)) {
+        compressed_image image;
+        if (!readCompressedTexture(job.path, image))
+            return;
+        if (job.target == GL_TEXTURE_2D_ARRAY &&
+            (image.format != job.format || image.width != job.width || image.height != job.height)) {
+            std::cout << "Cooked texture " << job.path << " does not match its texture array" << std::endl;
+            return;
+        }
+        job.format = image.format;
+        for (size_t i = 0; i < image.levels.size(); i++)
+            job.levels.push_back({std::max(1, image.width >> i), std::max(1, image.height >> i),
+                                  std::move(image.levels[i])});
+        return;
+    }
+
+    if (job.path.empty()) {
+        job.levels = generateMipChain(job.pixels.data(), job.width, job.height);
+    } else if (!decodeFile(job)) {
+        return;
+    }
+
+    if (job.format != BC_FORMAT_NONE) {
+        for (image_level &level : job.levels)
+            level.pixels = encodeImage(job.format, level.pixels.data(), level.width, level.height);
+    }
+}
+
+bool texture_loader::decodeFile(request &job) {
+    int width, height, channels;
+    stbi_set_flip_vertically_on_load_thread(job.flip);
+    unsigned char *data = stbi_load(job.path.c_str(), &width, &height, &channels, 4);
+    if (!data) {
+        std::cout << "Failed to load texture " << job.path << std::endl;
+        return false;
+    }
+
+    if (job.width != 0 && (width != job.width || height != job.height)) {
+        image_level resized = resizeImage(data, width, height, job.width, job.height);
+        job.levels = generateMipChain(resized.pixels.data(), resized.width, resized.height);
+    } else {
+        job.levels = generateMipChain(data, width, height);
+    }
+    stbi_image_free(data);
+    return true;
+}
+
+void texture_loader::update() {
+    PROFILE_SCOPE("Texture upload");
+    arena_vector<std::shared_ptr<request>> finished(frame_arena::allocator<std::shared_ptr<request>>());
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        // a texture is uploaded whole even when it goes over the budget
+        int levels = 0;
+        size_t count = 0;
+        while (count < completed.size() && levels < uploadBudget)
+            levels += static_cast<int>(completed[count++]->levels.size());
+        finished.assign(completed.begin(), completed.begin() + count);
+        completed.erase(completed.begin(), completed.begin() + count);
+    }
+
+    for (const std::shared_ptr<request> &job : finished)
+        upload(*job);
+}
+
+void texture_loader::upload(const request &job) {
+    size_t size = 0;
+    for (const image_level &level : job.levels)
+        size += level.pixels.size();
+
+    // orphaning the buffer lets the driver keep the previous upload in flight instead of stalling
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    memory_tracker::trackGPU(GPU_BUFFER, pbo, MEMORY_TEXTURES, size);
+    unsigned char *mapped = static_cast<unsigned char *>(
+            glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (!mapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return;
+    }
+
+    size_t offset = 0;
+    for (const image_level &level : job.levels) {
+        std::memcpy(mapped + offset, level.pixels.data(), level.pixels.size());
+        offset += level.pixels.size();
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    glBindTexture(job.target, job.textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    offset = 0;
+    for (size_t i = 0; i < job.levels.size(); i++) {
+        const image_level &level = job.levels[i];
+        // with a bound unpack buffer the pointer is an offset into it
+        const void *pixels = reinterpret_cast<const void *>(offset);
+        GLint index = static_cast<GLint>(i);
+        GLsizei size = static_cast<GLsizei>(level.pixels.size());
+        if (job.target == GL_TEXTURE_2D_ARRAY && job.format != BC_FORMAT_NONE) {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, index, 0, 0, job.layer, level.width, level.height, 1,
+                                      getCompressedGLFormat(job.format), size, pixels);
+        } else if (job.target == GL_TEXTURE_2D_ARRAY) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, index, 0, 0, job.layer, level.width, level.height, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        } else if (job.format != BC_FORMAT_NONE) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, index, getCompressedGLFormat(job.format), level.width, level.height,
+                                   0, size, pixels);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, index, GL_RGBA, level.width, level.height, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        }
+        offset += level.pixels.size();
+    }
+    if (job.target == GL_TEXTURE_2D_ARRAY) {
+        // a cooked chain may stop short of 1x1, the levels it lacks would stay undefined for this layer and sample
+        // black. The whole array stops at the shortest chain uploaded to it
+        GLint maxLevel = 0;
+        glGetTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+        if (static_cast<GLint>(job.levels.size() - 1) < maxLevel)
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(job.levels.size() - 1));
+    } else {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(job.levels.size() - 1));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        // array layers are already counted when the array is allocated
+        memory_tracker::trackGPU(GPU_TEXTURE, job.textureID, MEMORY_TEXTURES, size);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+int texture_loader::getPendingCount() {
+    std::lock_guard<std::mutex> lock(completedMutex);
+    return jobsInFlight.load() + static_cast<int>(completed.size());
+}
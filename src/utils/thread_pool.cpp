@@ -0,0 +1,68 @@
+#include "VoxelEngine/utils/thread_pool.h"
+#include "VoxelEngine/utils/profiler.h"
+#include <algorithm>
+
+thread_pool::thread_pool(unsigned int threadCount)
+{
+    if (threadCount == 0)
+        // hardware_concurrency may return 0 when unknown, which must not wrap around
+        threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+    workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back([this, i] {
+            profiler::setThreadName("Worker " + std::to_string(i));
+            workerLoop();
+        });
+    }
+}
+
+// pending jobs are still executed before the workers exit
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void thread_pool::enqueue(std::function<void()> job, int priority)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push({priority, submitted++, std::move(job)});
+    }
+    condition.notify_one();
+}
+
+size_t thread_pool::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size();
+}
+
+unsigned int thread_pool::getThreadCount() const
+{
+    return static_cast<unsigned int>(workers.size());
+}
+
+void thread_pool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+                return;
+            job = std::move(const_cast<Job &>(jobs.top()).run);
+            jobs.pop();
+        }
+        job();
+    }
+}
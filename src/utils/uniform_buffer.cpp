@@ -0,0 +1,23 @@
+#include "VoxelEngine/utils/uniform_buffer.h"
+#include "VoxelEngine/utils/memory_tracker.h"
+
+uniform_buffer::uniform_buffer(size_t size, unsigned int binding) : size(size) {
+    glGenBuffers(1, &bufferID);
+    glBindBuffer(GL_UNIFORM_BUFFER, bufferID);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_DRAW);
+    memory_tracker::trackGPU(GPU_BUFFER, bufferID, MEMORY_RENDERING, size);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, bufferID);
+}
+
+uniform_buffer::~uniform_buffer() {
+    glDeleteBuffers(1, &bufferID);
+    memory_tracker::releaseGPU(GPU_BUFFER, bufferID);
+}
+
+void uniform_buffer::update(const void *data) {
+    glBindBuffer(GL_UNIFORM_BUFFER, bufferID);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(size), data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,72 @@
+// Offline asset cook step: converts an image to a block compressed .vtex file with its full mip chain
+// usage: TextureCook <input image> <output.vtex> [bc1|bc3|bc7]
+
+#include "VoxelEngine/utils/compressed_texture.h"
+#include "VoxelEngine/utils/mipmap.h"
+#include "VoxelEngine/utils/stb_image.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+// peak signal to noise ratio of the decoded level against its source, printed so the cook can be checked anywhere
+double computePSNR(const std::vector<unsigned char> &source, const std::vector<unsigned char> &decoded);
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cout << "usage: TextureCook <input image> <output.vtex> [bc1|bc3|bc7]" << std::endl;
+        return 1;
+    }
+
+    std::string formatName = argc > 3 ? argv[3] : "bc1";
+    bc_format format;
+    if (formatName == "bc1")
+        format = BC_FORMAT_BC1;
+    else if (formatName == "bc3")
+        format = BC_FORMAT_BC3;
+    else if (formatName == "bc7")
+        format = BC_FORMAT_BC7;
+    else {
+        std::cout << "Unknown format " << formatName << std::endl;
+        return 1;
+    }
+
+    int width, height, channels;
+    unsigned char *data = stbi_load(argv[1], &width, &height, &channels, 4);
+    if (!data) {
+        std::cout << "Failed to load texture " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::vector<image_level> mips = generateMipChain(data, width, height);
+    stbi_image_free(data);
+
+    compressed_image image{format, width, height, {}};
+    size_t rawSize = 0, compressedSize = 0;
+    for (const image_level &level : mips) {
+        image.levels.push_back(encodeImage(format, level.pixels.data(), level.width, level.height));
+
+        std::vector<unsigned char> decoded = decodeImage(format, image.levels.back().data(), level.width, level.height);
+        std::cout << "level " << image.levels.size() - 1 << " " << level.width << "x" << level.height
+                  << " PSNR " << computePSNR(level.pixels, decoded) << " dB" << std::endl;
+
+        rawSize += level.pixels.size();
+        compressedSize += image.levels.back().size();
+    }
+
+    if (!writeCompressedTexture(argv[2], image))
+        return 1;
+
+    std::cout << argv[2] << ": " << rawSize << " -> " << compressedSize << " bytes" << std::endl;
+    return 0;
+}
+
+double computePSNR(const std::vector<unsigned char> &source, const std::vector<unsigned char> &decoded) {
+    double error = 0.0;
+    for (size_t i = 0; i < source.size(); i++) {
+        double d = static_cast<double>(source[i]) - decoded[i];
+        error += d * d;
+    }
+    error /= static_cast<double>(source.size());
+    return error == 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / error);
+}